@@ -0,0 +1,198 @@
+// Arena.cpp
+#include "Arena.hpp"
+
+#include <algorithm>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace life {
+namespace {
+constexpr std::size_t HUGE_PAGE = std::size_t(2) << 20;
+// Pool chunks hold at least this many bytes and this many blocks.
+constexpr std::size_t POOL_CHUNK_BYTES = std::size_t(256) << 10;
+constexpr std::size_t POOL_CHUNK_BLOCKS = 64;
+
+std::size_t roundUp(const std::size_t bytes, const std::size_t to) {
+  return (bytes + to - 1) / to * to;
+}
+
+ArenaChunk reserveChunk(std::size_t bytes, const bool hugePages) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  if (hugePages) {
+    bytes = roundUp(bytes, HUGE_PAGE);
+    void *data = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (data != MAP_FAILED) {
+      // Only advice: without transparent huge pages it is ordinary memory.
+      madvise(data, bytes, MADV_HUGEPAGE);
+      return ArenaChunk{static_cast<char *>(data), bytes, true};
+    }
+  }
+#else
+  (void)hugePages;
+#endif
+  return ArenaChunk{static_cast<char *>(::operator new(
+                        bytes, std::align_val_t(CACHE_LINE))),
+                    bytes, false};
+}
+
+void freeChunk(const ArenaChunk &chunk) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  if (chunk.mapped) {
+    munmap(chunk.data, chunk.bytes);
+    return;
+  }
+#endif
+  ::operator delete(chunk.data, std::align_val_t(CACHE_LINE));
+}
+
+void freeChunks(std::vector<ArenaChunk> &chunks) {
+  for (const ArenaChunk &chunk : chunks) {
+    freeChunk(chunk);
+  }
+  chunks.clear();
+}
+
+void noteInUse(ArenaStats &counts, const std::size_t inUse) {
+  counts.inUse = inUse;
+  counts.highWater = std::max(counts.highWater, inUse);
+}
+} // namespace
+
+TilePool::TilePool(const std::size_t blockSize, const bool hugePages)
+    : blockSize(roundUp(std::max<std::size_t>(blockSize, 1), CACHE_LINE)),
+      hugePages(hugePages) {
+  chunkBytes = std::max(POOL_CHUNK_BYTES, this->blockSize * POOL_CHUNK_BLOCKS);
+  if (hugePages) {
+    chunkBytes = roundUp(chunkBytes, HUGE_PAGE);
+  }
+}
+
+TilePool::TilePool(TilePool &&other) noexcept
+    : blockSize(other.blockSize), chunkBytes(other.chunkBytes),
+      hugePages(other.hugePages), chunks(std::move(other.chunks)),
+      freeList(other.freeList), fresh(other.fresh),
+      freshEnd(other.freshEnd), counts(other.counts) {
+  other.chunks.clear();
+  other.freeList = nullptr;
+  other.fresh = nullptr;
+  other.freshEnd = nullptr;
+  other.counts = ArenaStats{};
+}
+
+TilePool &TilePool::operator=(TilePool &&other) noexcept {
+  if (this != &other) {
+    freeChunks(chunks);
+    blockSize = other.blockSize;
+    chunkBytes = other.chunkBytes;
+    hugePages = other.hugePages;
+    chunks = std::move(other.chunks);
+    freeList = other.freeList;
+    fresh = other.fresh;
+    freshEnd = other.freshEnd;
+    counts = other.counts;
+    other.chunks.clear();
+    other.freeList = nullptr;
+    other.fresh = nullptr;
+    other.freshEnd = nullptr;
+    other.counts = ArenaStats{};
+  }
+  return *this;
+}
+
+TilePool::~TilePool() { freeChunks(chunks); }
+
+void *TilePool::allocate() {
+  void *block;
+  if (freeList != nullptr) {
+    block = freeList;
+    freeList = *static_cast<void **>(freeList);
+  } else {
+    if (fresh == freshEnd) {
+      const ArenaChunk chunk = reserveChunk(chunkBytes, hugePages);
+      chunks.push_back(chunk);
+      counts.reserved += chunk.bytes;
+      fresh = chunk.data;
+      freshEnd = chunk.data + chunk.bytes / blockSize * blockSize;
+    }
+    block = fresh;
+    fresh += blockSize;
+  }
+  noteInUse(counts, counts.inUse + blockSize);
+  return block;
+}
+
+void TilePool::release(void *block) {
+  *static_cast<void **>(block) = freeList;
+  freeList = block;
+  counts.inUse -= blockSize;
+}
+
+ScratchArena::ScratchArena(const std::size_t chunkBytes, const bool hugePages)
+    : chunkBytes(std::max(chunkBytes, CACHE_LINE)), hugePages(hugePages) {}
+
+ScratchArena::ScratchArena(ScratchArena &&other) noexcept
+    : chunkBytes(other.chunkBytes), hugePages(other.hugePages),
+      chunks(std::move(other.chunks)), current(other.current),
+      offset(other.offset), counts(other.counts) {
+  other.chunks.clear();
+  other.current = 0;
+  other.offset = 0;
+  other.counts = ArenaStats{};
+}
+
+ScratchArena &ScratchArena::operator=(ScratchArena &&other) noexcept {
+  if (this != &other) {
+    freeChunks(chunks);
+    chunkBytes = other.chunkBytes;
+    hugePages = other.hugePages;
+    chunks = std::move(other.chunks);
+    current = other.current;
+    offset = other.offset;
+    counts = other.counts;
+    other.chunks.clear();
+    other.current = 0;
+    other.offset = 0;
+    other.counts = ArenaStats{};
+  }
+  return *this;
+}
+
+ScratchArena::~ScratchArena() { freeChunks(chunks); }
+
+void *ScratchArena::allocate(const std::size_t bytes,
+                             const std::size_t alignment) {
+  // Chunks start on a cache line, so aligning the offset aligns the
+  // address for any alignment up to that.
+  std::size_t start = roundUp(offset, alignment);
+  while (current < chunks.size() && start + bytes > chunks[current].bytes) {
+    current++;
+    start = 0;
+  }
+  if (current == chunks.size()) {
+    const ArenaChunk chunk =
+        reserveChunk(std::max(chunkBytes, roundUp(bytes, alignment)), hugePages);
+    chunks.push_back(chunk);
+    counts.reserved += chunk.bytes;
+    start = 0;
+  }
+  offset = start + bytes;
+  noteInUse(counts, counts.inUse + bytes);
+  return chunks[current].data + start;
+}
+
+void ScratchArena::reset() {
+  if (chunks.size() > 1) {
+    const std::size_t bytes = counts.reserved;
+    freeChunks(chunks);
+    chunks.push_back(reserveChunk(bytes, hugePages));
+    counts.reserved = chunks.back().bytes;
+  }
+  current = 0;
+  offset = 0;
+  counts.inUse = 0;
+}
+
+} // namespace life
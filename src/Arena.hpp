@@ -0,0 +1,117 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace life {
+
+constexpr std::size_t CACHE_LINE = 64;
+
+// Memory handed out by an allocator, at its peak, and taken from the
+// system to hand out, in bytes.
+struct ArenaStats {
+    std::size_t inUse = 0;
+    std::size_t highWater = 0;
+    std::size_t reserved = 0;
+};
+
+// A run of memory an allocator carves up.
+struct ArenaChunk {
+    char *data = nullptr;
+    std::size_t bytes = 0;
+    // Mapped for huge pages rather than taken from operator new.
+    bool mapped = false;
+};
+
+// Fixed-size blocks, each starting on a cache line, carved from large
+// chunks and recycled through a free list, so creating and freeing tiles
+// by the thousand never reaches the global allocator once the pool has
+// grown to its working size. Not thread-safe: each board or thread owns
+// its pool, so none is contended. Chunks go back to the system only when
+// the pool is destroyed.
+class TilePool {
+private:
+  std::size_t blockSize;
+  std::size_t chunkBytes;
+  bool hugePages;
+  std::vector<ArenaChunk> chunks;
+  // Released blocks, linked through their first bytes.
+  void *freeList = nullptr;
+  // The part of the newest chunk not yet handed out.
+  char *fresh = nullptr;
+  char *freshEnd = nullptr;
+  ArenaStats counts;
+
+public:
+  // Blocks are blockSize rounded up to a whole cache line. With hugePages
+  // the chunks are 2 MiB mappings the kernel is asked to back with huge
+  // pages, where it supports them.
+  explicit TilePool(std::size_t blockSize, bool hugePages = false);
+  TilePool(TilePool &&other) noexcept;
+  TilePool &operator=(TilePool &&other) noexcept;
+  TilePool(const TilePool &) = delete;
+  TilePool &operator=(const TilePool &) = delete;
+  ~TilePool();
+
+  void *allocate();
+  // Returns a block from this pool for reuse.
+  void release(void *block);
+  // allocate and release with a constructor and destructor run, for T no
+  // bigger than the blocks.
+  template <typename T, typename... Args> T *create(Args &&...args) {
+    return new (allocate()) T(std::forward<Args>(args)...);
+  }
+  template <typename T> void destroy(T *object) {
+    object->~T();
+    release(object);
+  }
+
+  std::size_t size() const { return blockSize; }
+  const ArenaStats &stats() const { return counts; }
+};
+
+// A bump allocator for scratch that lives for one generation: allocations
+// are a pointer increment, nothing is freed singly, and reset frees it all
+// at once. Memory is kept across resets, so a step that needs the same
+// scratch as the last allocates nothing. Not thread-safe.
+class ScratchArena {
+private:
+  std::size_t chunkBytes;
+  bool hugePages;
+  std::vector<ArenaChunk> chunks;
+  // The chunk being carved and the offset of its first free byte.
+  std::size_t current = 0;
+  std::size_t offset = 0;
+  ArenaStats counts;
+
+public:
+  explicit ScratchArena(std::size_t chunkBytes = 1 << 20,
+                        bool hugePages = false);
+  ScratchArena(ScratchArena &&other) noexcept;
+  ScratchArena &operator=(ScratchArena &&other) noexcept;
+  ScratchArena(const ScratchArena &) = delete;
+  ScratchArena &operator=(const ScratchArena &) = delete;
+  ~ScratchArena();
+
+  // alignment is a power of two no more than CACHE_LINE.
+  void *allocate(std::size_t bytes, std::size_t alignment = CACHE_LINE);
+  // Room for count Ts on a cache line, unconstructed; T must not need
+  // destroying.
+  template <typename T> T *allocate(std::size_t count) {
+    static_assert(alignof(T) <= CACHE_LINE, "over-aligned scratch");
+    return static_cast<T *>(allocate(count * sizeof(T), CACHE_LINE));
+  }
+  // Frees everything allocated since the last reset. Scratch that spilled
+  // into more than one chunk is merged into one chunk big enough for all
+  // of it, so a steady workload settles into a single chunk.
+  void reset();
+
+  const ArenaStats &stats() const { return counts; }
+};
+
+} // namespace life
+
+#endif // ARENA_H
@@ -0,0 +1,36 @@
+// CycleDetector.cpp
+#include "CycleDetector.hpp"
+
+#include <algorithm>
+
+namespace life {
+
+CycleDetector::CycleDetector(const int maxPeriod)
+    : recent(static_cast<std::size_t>(std::max(0, maxPeriod)), 0) {}
+
+void CycleDetector::reset() {
+  states = 0;
+  found = 0;
+}
+
+int CycleDetector::record(const std::uint64_t hash) {
+  const std::uint64_t slots = recent.size();
+  found = 0;
+  if (slots == 0) {
+    return found;
+  }
+  const std::uint64_t furthest = std::min(slots, states);
+  for (std::uint64_t period = 1; period <= furthest; period++) {
+    if (recent[(states - period) % slots] == hash) {
+      found = static_cast<int>(period);
+      break;
+    }
+  }
+  // The slot being overwritten holds the state maxPeriod back, compared
+  // above.
+  recent[states % slots] = hash;
+  states++;
+  return found;
+}
+
+} // namespace life
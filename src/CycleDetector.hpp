@@ -0,0 +1,39 @@
+#ifndef CYCLEDETECTOR_H
+#define CYCLEDETECTOR_H
+
+#include <cstdint>
+#include <vector>
+
+namespace life {
+
+// Notices a board returning to a state it held within the last maxPeriod
+// generations, from a ring of its recent GameBoard::hash values. Equal
+// hashes are taken as equal boards; for distinct boards the chance of a
+// 64-bit Zobrist collision is negligible.
+class CycleDetector {
+private:
+  // State n's hash at n % maxPeriod, for the last maxPeriod states.
+  std::vector<std::uint64_t> recent;
+  std::uint64_t states = 0;
+  int found = 0;
+
+public:
+  // maxPeriod 0 never finds a period.
+  explicit CycleDetector(int maxPeriod = 64);
+
+  // Forgets every state, e.g. after an edit.
+  void reset();
+  // Records the board's hash, once per generation. Returns the shortest
+  // period with which it repeats one of the recorded states, 1 for a still
+  // life, or 0 if it repeats none.
+  int record(std::uint64_t hash);
+  // What the last record returned.
+  int period() const { return found; }
+  int maxPeriod() const { return static_cast<int>(recent.size()); }
+  // States recorded since the last reset.
+  std::uint64_t size() const { return states; }
+};
+
+} // namespace life
+
+#endif // CYCLEDETECTOR_H
@@ -0,0 +1,392 @@
+// HashLife.cpp
+#include "HashLife.hpp"
+
+#include <algorithm>
+
+namespace life {
+
+std::size_t HashLife::KeyHash::operator()(const Key &key) const {
+  std::uint64_t h = key.nw;
+  h = h * 0x9E3779B97F4A7C15ull + key.ne;
+  h = h * 0x9E3779B97F4A7C15ull + key.sw;
+  h = h * 0x9E3779B97F4A7C15ull + key.se;
+  return static_cast<std::size_t>(h ^ (h >> 29));
+}
+
+HashLife::HashLife(const std::size_t maxNodes) : maxNodes(maxNodes) {
+  reset();
+}
+
+void HashLife::reset() {
+  nodes.clear();
+  canonical.clear();
+  results.clear();
+  emptyNodes.clear();
+  nodes.push_back(Node{0, 0, 0, 0, 0, 0});
+  nodes.push_back(Node{0, 0, 0, 0, 0, 1});
+  emptyNodes.push_back(DEAD_CELL);
+  root = empty(3);
+  originX = 0;
+  originY = 0;
+}
+
+HashLife::NodeId HashLife::join(const NodeId nw, const NodeId ne,
+                                const NodeId sw, const NodeId se) {
+  const Key key{nw, ne, sw, se};
+  const auto found = canonical.find(key);
+  if (found != canonical.end()) {
+    return found->second;
+  }
+  const NodeId id = static_cast<NodeId>(nodes.size());
+  nodes.push_back(Node{nw, ne, sw, se, nodes[nw].level + 1,
+                       nodes[nw].population + nodes[ne].population +
+                           nodes[sw].population + nodes[se].population});
+  canonical.emplace(key, id);
+  return id;
+}
+
+HashLife::NodeId HashLife::empty(const int level) {
+  while (static_cast<int>(emptyNodes.size()) <= level) {
+    const NodeId below = emptyNodes.back();
+    emptyNodes.push_back(join(below, below, below, below));
+  }
+  return emptyNodes[level];
+}
+
+HashLife::NodeId HashLife::centre(const NodeId id) {
+  const Node node = nodes[id];
+  return join(nodes[node.nw].se, nodes[node.ne].sw, nodes[node.sw].ne,
+              nodes[node.se].nw);
+}
+
+// A level 2 node is 4x4 cells; its centre 2x2 is stepped directly.
+HashLife::NodeId HashLife::baseSuccessor(const NodeId id) {
+  int cells[4][4];
+  const Node &node = nodes[id];
+  const NodeId quadrants[4] = {node.nw, node.ne, node.sw, node.se};
+  for (int q = 0; q < 4; q++) {
+    const Node &quadrant = nodes[quadrants[q]];
+    const int x = (q % 2) * 2;
+    const int y = (q / 2) * 2;
+    cells[y][x] = static_cast<int>(quadrant.nw);
+    cells[y][x + 1] = static_cast<int>(quadrant.ne);
+    cells[y + 1][x] = static_cast<int>(quadrant.sw);
+    cells[y + 1][x + 1] = static_cast<int>(quadrant.se);
+  }
+  NodeId next[4];
+  for (int i = 0; i < 4; i++) {
+    const int x = 1 + i % 2;
+    const int y = 1 + i / 2;
+    int count = 0;
+    for (int j = y - 1; j <= y + 1; j++) {
+      for (int k = x - 1; k <= x + 1; k++) {
+        count += cells[j][k];
+      }
+    }
+    count -= cells[y][x];
+    next[i] = (count == 3 || (count == 2 && cells[y][x])) ? ALIVE_CELL
+                                                           : DEAD_CELL;
+  }
+  return join(next[0], next[1], next[2], next[3]);
+}
+
+// Returns the level k - 1 centre of a level k node advanced by 2^log2
+// generations, where log2 <= k - 2.
+HashLife::NodeId HashLife::successor(const NodeId id, const int log2) {
+  const Node node = nodes[id];
+  if (node.population == 0) {
+    return empty(node.level - 1);
+  }
+  const std::uint64_t key = (static_cast<std::uint64_t>(id) << 8) | log2;
+  const auto found = results.find(key);
+  if (found != results.end()) {
+    hits++;
+    return found->second;
+  }
+  misses++;
+
+  NodeId result;
+  if (node.level == 2) {
+    result = baseSuccessor(id);
+  } else {
+    const Node nw = nodes[node.nw];
+    const Node ne = nodes[node.ne];
+    const Node sw = nodes[node.sw];
+    const Node se = nodes[node.se];
+    // Nine overlapping level k - 1 nodes covering the node.
+    const NodeId parts[9] = {
+        node.nw,
+        join(nw.ne, ne.nw, nw.se, ne.sw),
+        node.ne,
+        join(nw.sw, nw.se, sw.nw, sw.ne),
+        join(nw.se, ne.sw, sw.ne, se.nw),
+        join(ne.sw, ne.se, se.nw, se.ne),
+        node.sw,
+        join(sw.ne, se.nw, sw.se, se.sw),
+        node.se,
+    };
+    // Full speed takes two half steps; slower steps only advance in the
+    // second stage and take plain centres in the first.
+    const bool fullSpeed = log2 == node.level - 2;
+    NodeId stage[9];
+    for (int i = 0; i < 9; i++) {
+      stage[i] = fullSpeed ? successor(parts[i], log2 - 1) : centre(parts[i]);
+    }
+    const NodeId quadrants[4] = {
+        join(stage[0], stage[1], stage[3], stage[4]),
+        join(stage[1], stage[2], stage[4], stage[5]),
+        join(stage[3], stage[4], stage[6], stage[7]),
+        join(stage[4], stage[5], stage[7], stage[8]),
+    };
+    const int nextLog2 = fullSpeed ? log2 - 1 : log2;
+    result = join(successor(quadrants[0], nextLog2),
+                  successor(quadrants[1], nextLog2),
+                  successor(quadrants[2], nextLog2),
+                  successor(quadrants[3], nextLog2));
+  }
+
+  if (results.size() >= maxNodes) {
+    results.clear();
+    evictions++;
+  }
+  results.emplace(key, result);
+  return result;
+}
+
+// Doubles the root, keeping the current root in the middle.
+void HashLife::expand() {
+  const Node node = nodes[root];
+  const NodeId border = empty(node.level - 1);
+  root = join(join(border, border, border, node.nw),
+              join(border, border, node.ne, border),
+              join(border, node.sw, border, border),
+              join(node.se, border, border, border));
+  const std::int64_t shift = std::int64_t(1) << (node.level - 1);
+  originX -= shift;
+  originY -= shift;
+}
+
+// Drops empty margins so the tree stays as small as the pattern allows.
+void HashLife::shrink() {
+  while (nodes[root].level > 3) {
+    const NodeId inner = centre(root);
+    if (nodes[inner].population != nodes[root].population) {
+      return;
+    }
+    const std::int64_t shift = std::int64_t(1) << (nodes[root].level - 2);
+    root = inner;
+    originX += shift;
+    originY += shift;
+  }
+}
+
+// Rebuilds the node table with only the nodes reachable from the root.
+void HashLife::collect() {
+  std::vector<Node> old;
+  old.swap(nodes);
+  const NodeId oldRoot = root;
+  const std::int64_t x = originX;
+  const std::int64_t y = originY;
+  reset();
+  originX = x;
+  originY = y;
+  std::vector<NodeId> remap(old.size(), 0);
+  std::vector<char> mapped(old.size(), 0);
+  remap[DEAD_CELL] = DEAD_CELL;
+  remap[ALIVE_CELL] = ALIVE_CELL;
+  mapped[DEAD_CELL] = mapped[ALIVE_CELL] = 1;
+  // Iterative post-order walk so deep trees cannot overflow the stack.
+  std::vector<NodeId> stack{oldRoot};
+  while (!stack.empty()) {
+    const NodeId id = stack.back();
+    if (mapped[id]) {
+      stack.pop_back();
+      continue;
+    }
+    const Node &node = old[id];
+    const NodeId children[4] = {node.nw, node.ne, node.sw, node.se};
+    bool ready = true;
+    for (const NodeId child : children) {
+      if (!mapped[child]) {
+        stack.push_back(child);
+        ready = false;
+      }
+    }
+    if (ready) {
+      remap[id] = join(remap[node.nw], remap[node.ne], remap[node.sw],
+                       remap[node.se]);
+      mapped[id] = 1;
+      stack.pop_back();
+    }
+  }
+  root = remap[oldRoot];
+  evictions++;
+}
+
+void HashLife::stepPow2(const int log2) {
+  if (log2 <= MAX_STEP_LOG2) {
+    jump(log2);
+    return;
+  }
+  const std::uint64_t jumps = std::uint64_t(1) << (log2 - MAX_STEP_LOG2);
+  for (std::uint64_t i = 0; i < jumps; i++) {
+    jump(MAX_STEP_LOG2);
+  }
+}
+
+void HashLife::jump(const int log2) {
+  // The pattern has to sit in the middle quarter of a root at least three
+  // levels above the step, so nothing it can reach falls outside the
+  // result.
+  const auto centred = [this] {
+    // centre can grow nodes, so take the inner node before reading either.
+    const NodeId inner = centre(centre(root));
+    return nodes[inner].population == nodes[root].population;
+  };
+  while (nodes[root].level < log2 + 3 || !centred()) {
+    expand();
+  }
+  const std::int64_t shift = std::int64_t(1) << (nodes[root].level - 2);
+  root = successor(root, log2);
+  originX += shift;
+  originY += shift;
+  generationCount += std::uint64_t(1) << log2;
+  shrink();
+  if (nodes.size() > maxNodes) {
+    collect();
+  }
+}
+
+void HashLife::step(std::uint64_t generations) {
+  for (int log2 = 0; generations != 0; log2++, generations >>= 1) {
+    if (generations & 1) {
+      stepPow2(log2);
+    }
+  }
+}
+
+HashLife::NodeId HashLife::build(const GameBoard &gameBoard,
+                                 const std::int64_t x, const std::int64_t y,
+                                 const int level) {
+  if (x >= gameBoard.width || y >= gameBoard.height) {
+    return empty(level);
+  }
+  if (level == 0) {
+    return life::getCellState(gameBoard, static_cast<int>(x),
+                              static_cast<int>(y)) == ALIVE
+               ? ALIVE_CELL
+               : DEAD_CELL;
+  }
+  const std::int64_t half = std::int64_t(1) << (level - 1);
+  return join(build(gameBoard, x, y, level - 1),
+              build(gameBoard, x + half, y, level - 1),
+              build(gameBoard, x, y + half, level - 1),
+              build(gameBoard, x + half, y + half, level - 1));
+}
+
+bool HashLife::importBoard(const GameBoard &gameBoard) {
+  if (gameBoard.rule != CONWAY) {
+    return false;
+  }
+  reset();
+  int level = 3;
+  while ((std::int64_t(1) << level) <
+         std::max(gameBoard.width, gameBoard.height)) {
+    level++;
+  }
+  root = build(gameBoard, 0, 0, level);
+  generationCount = 0;
+  return true;
+}
+
+void HashLife::exportNode(GameBoard &gameBoard, const NodeId id,
+                          const std::int64_t x, const std::int64_t y) const {
+  const Node &node = nodes[id];
+  const std::int64_t size = std::int64_t(1) << node.level;
+  if (node.population == 0 || x >= gameBoard.width || y >= gameBoard.height ||
+      x + size <= 0 || y + size <= 0) {
+    return;
+  }
+  if (node.level == 0) {
+    // A bare alive bit; exportBoard rebuilds the rest.
+    gameBoard.board[y * gameBoard.width + x] = ALIVE;
+    return;
+  }
+  const std::int64_t half = size / 2;
+  exportNode(gameBoard, node.nw, x, y);
+  exportNode(gameBoard, node.ne, x + half, y);
+  exportNode(gameBoard, node.sw, x, y + half);
+  exportNode(gameBoard, node.se, x + half, y + half);
+}
+
+void HashLife::exportBoard(GameBoard &gameBoard) const {
+  // Cleared in place, so the board keeps its rule, its tracking and its
+  // buffers' capacity.
+  std::fill(gameBoard.board.begin(), gameBoard.board.end(), 0);
+  exportNode(gameBoard, root, originX, originY);
+  rebuildBoard(gameBoard);
+}
+
+char HashLife::getCellState(std::int64_t x, std::int64_t y) const {
+  x -= originX;
+  y -= originY;
+  NodeId id = root;
+  std::int64_t size = std::int64_t(1) << nodes[id].level;
+  if (x < 0 || y < 0 || x >= size || y >= size) {
+    return DEAD;
+  }
+  while (nodes[id].level > 0) {
+    const Node &node = nodes[id];
+    size /= 2;
+    const bool east = x >= size;
+    const bool south = y >= size;
+    id = south ? (east ? node.se : node.sw) : (east ? node.ne : node.nw);
+    x -= east ? size : 0;
+    y -= south ? size : 0;
+  }
+  return id == ALIVE_CELL ? ALIVE : DEAD;
+}
+
+HashLife::NodeId HashLife::setCell(const NodeId id, const std::int64_t x,
+                                   const std::int64_t y, const char state) {
+  const Node node = nodes[id];
+  if (node.level == 0) {
+    return state == ALIVE ? ALIVE_CELL : DEAD_CELL;
+  }
+  const std::int64_t half = std::int64_t(1) << (node.level - 1);
+  const bool east = x >= half;
+  const bool south = y >= half;
+  const std::int64_t cx = east ? x - half : x;
+  const std::int64_t cy = south ? y - half : y;
+  return join(!east && !south ? setCell(node.nw, cx, cy, state) : node.nw,
+              east && !south ? setCell(node.ne, cx, cy, state) : node.ne,
+              !east && south ? setCell(node.sw, cx, cy, state) : node.sw,
+              east && south ? setCell(node.se, cx, cy, state) : node.se);
+}
+
+void HashLife::setCellState(const std::int64_t x, const std::int64_t y,
+                            const char state) {
+  while (true) {
+    const std::int64_t size = std::int64_t(1) << nodes[root].level;
+    if (x >= originX && y >= originY && x < originX + size &&
+        y < originY + size) {
+      break;
+    }
+    expand();
+  }
+  root = setCell(root, x - originX, y - originY, state);
+}
+
+std::uint64_t HashLife::population() const { return nodes[root].population; }
+
+HashLife::CacheStats HashLife::cacheStats() const {
+  CacheStats stats;
+  stats.hits = hits;
+  stats.misses = misses;
+  stats.evictions = evictions;
+  stats.nodes = nodes.size();
+  stats.results = results.size();
+  return stats;
+}
+
+} // namespace life
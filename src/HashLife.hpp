@@ -0,0 +1,123 @@
+#ifndef HASHLIFE_H
+#define HASHLIFE_H
+
+#include "life.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace life {
+
+// Gosper's HashLife. The universe is a quadtree whose nodes are
+// canonicalised, so identical regions are shared, and the result of
+// advancing a node's centre is memoised. That lets step() jump by billions
+// of generations.
+//
+// HashLife runs on an unbounded plane. It matches iterateBoard on a
+// GameBoard as long as the pattern stays clear of the board's edges, with
+// any boundary: nothing wraps round a torus or Klein bottle here, and
+// nothing dies against a dead edge. Steps Conway's rule only.
+class HashLife {
+public:
+  struct CacheStats {
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    // Times the result cache was dropped or the node table rebuilt to stay
+    // within the memory bound.
+    std::uint64_t evictions = 0;
+    std::size_t nodes = 0;
+    std::size_t results = 0;
+  };
+
+  // maxNodes bounds both the node table and the result cache.
+  explicit HashLife(std::size_t maxNodes = std::size_t(1) << 22);
+
+  // Replaces the universe with the live cells of the board, placed with
+  // the board's (0, 0) at the plane's (0, 0). Returns false, leaving the
+  // universe as it was, for a board with a rule other than Conway's.
+  bool importBoard(const GameBoard &gameBoard);
+  // Clears the board's cells and writes the part of the universe that
+  // overlaps them. The board keeps its rule, boundary and tracking.
+  void exportBoard(GameBoard &gameBoard) const;
+
+  char getCellState(std::int64_t x, std::int64_t y) const;
+  void setCellState(std::int64_t x, std::int64_t y, char state);
+
+  // Advances by any number of generations, as a sum of powers of two.
+  void step(std::uint64_t generations);
+  // Advances by 2^log2 generations, log2 below 64, in one memoised jump,
+  // or in jumps of 2^MAX_STEP_LOG2 past that.
+  void stepPow2(int log2);
+  // A jump of 2^log2 needs a root of level log2 + 3 or a little more, and
+  // node sizes and the root's origin are int64s, so the root is kept to
+  // level 62 by jumping no further than this. Coordinates hold as long as
+  // the pattern stays within 2^58 cells of the origin.
+  static constexpr int MAX_STEP_LOG2 = 58;
+
+  std::uint64_t generation() const { return generationCount; }
+  std::uint64_t population() const;
+  CacheStats cacheStats() const;
+
+private:
+  using NodeId = std::uint32_t;
+
+  // Level 0 nodes are single cells; a level k node is 2^k cells square.
+  struct Node {
+    NodeId nw, ne, sw, se;
+    int level;
+    std::uint64_t population;
+  };
+
+  struct Key {
+    NodeId nw, ne, sw, se;
+    bool operator==(const Key &other) const {
+      return nw == other.nw && ne == other.ne && sw == other.sw &&
+             se == other.se;
+    }
+  };
+  struct KeyHash {
+    std::size_t operator()(const Key &key) const;
+  };
+
+  static constexpr NodeId DEAD_CELL = 0;
+  static constexpr NodeId ALIVE_CELL = 1;
+
+  std::size_t maxNodes;
+  std::vector<Node> nodes;
+  std::unordered_map<Key, NodeId, KeyHash> canonical;
+  // (node << 8 | log2 step) -> node centre advanced by 2^log2.
+  std::unordered_map<std::uint64_t, NodeId> results;
+  std::vector<NodeId> emptyNodes;
+
+  NodeId root;
+  // Plane coordinates of the root's top-left cell.
+  std::int64_t originX = 0;
+  std::int64_t originY = 0;
+  std::uint64_t generationCount = 0;
+
+  std::uint64_t hits = 0;
+  std::uint64_t misses = 0;
+  std::uint64_t evictions = 0;
+
+  void reset();
+  NodeId join(NodeId nw, NodeId ne, NodeId sw, NodeId se);
+  NodeId empty(int level);
+  NodeId centre(NodeId node);
+  NodeId successor(NodeId node, int log2);
+  // stepPow2 for log2 up to MAX_STEP_LOG2.
+  void jump(int log2);
+  NodeId baseSuccessor(NodeId node);
+  NodeId build(const GameBoard &gameBoard, std::int64_t x, std::int64_t y,
+               int level);
+  NodeId setCell(NodeId node, std::int64_t x, std::int64_t y, char state);
+  void expand();
+  void shrink();
+  void collect();
+  void exportNode(GameBoard &gameBoard, NodeId node, std::int64_t x,
+                  std::int64_t y) const;
+};
+
+} // namespace life
+
+#endif // HASHLIFE_H
@@ -0,0 +1,247 @@
+// Renderer.cpp
+#include "Renderer.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace life {
+namespace {
+constexpr SDL_FColor WHITE{1.0f, 1.0f, 1.0f, 1.0f};
+constexpr std::uint32_t TEXEL_ALIVE = 0xFFFFFFFF;
+constexpr std::uint32_t TEXEL_DEAD = 0xFF000000;
+} // namespace
+
+const char *renderBackendName(const RenderBackend backend) {
+  switch (backend) {
+  case RenderBackend::POINTS:
+    return "points";
+  case RenderBackend::RECTS:
+    return "rects";
+  case RenderBackend::GEOMETRY:
+    return "geometry";
+  case RenderBackend::TEXTURE:
+    return "texture";
+  case RenderBackend::DIFF:
+    return "diff";
+  }
+  return "unknown";
+}
+
+RenderBackend nextRenderBackend(const RenderBackend backend) {
+  switch (backend) {
+  case RenderBackend::POINTS:
+    return RenderBackend::RECTS;
+  case RenderBackend::RECTS:
+    return RenderBackend::GEOMETRY;
+  case RenderBackend::GEOMETRY:
+    return RenderBackend::TEXTURE;
+  case RenderBackend::TEXTURE:
+    return RenderBackend::DIFF;
+  case RenderBackend::DIFF:
+    return RenderBackend::POINTS;
+  }
+  return RenderBackend::RECTS;
+}
+
+Renderer::Renderer(SDL_Renderer *renderer, const RenderBackend backend)
+    : renderer(renderer), current(backend) {}
+
+Renderer::~Renderer() {
+  if (texture != nullptr) {
+    SDL_DestroyTexture(texture);
+  }
+}
+
+void Renderer::setBackend(const RenderBackend backend) { current = backend; }
+
+bool Renderer::draw(const GameBoard &gameBoard, const int cellSize) {
+  switch (current) {
+  case RenderBackend::POINTS:
+    return drawPoints(gameBoard, cellSize);
+  case RenderBackend::RECTS:
+    return drawRects(gameBoard, cellSize);
+  case RenderBackend::GEOMETRY:
+    return drawGeometry(gameBoard, cellSize);
+  case RenderBackend::TEXTURE:
+    return drawTexture(gameBoard, cellSize);
+  case RenderBackend::DIFF:
+    return drawDiff(gameBoard, cellSize);
+  }
+  return false;
+}
+
+bool Renderer::drawPoints(const GameBoard &gameBoard, const int cellSize) {
+  SDL_SetRenderDrawColor(renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
+  const AliveList &aliveList = gameBoard.aliveList;
+  for (std::size_t i = 0; i < aliveList.size(); i++) {
+    const int x = aliveList.x[i] * cellSize;
+    const int y = aliveList.y[i] * cellSize;
+    for (int yD = y; yD < y + cellSize; yD++) {
+      for (int xD = x; xD < x + cellSize; xD++) {
+        if (!SDL_RenderPoint(renderer, static_cast<float>(xD),
+                             static_cast<float>(yD))) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+bool Renderer::drawRects(const GameBoard &gameBoard, const int cellSize) {
+  const AliveList &aliveList = gameBoard.aliveList;
+  const float size = static_cast<float>(cellSize);
+  rects.resize(aliveList.size());
+  for (std::size_t i = 0; i < aliveList.size(); i++) {
+    rects[i] = SDL_FRect{aliveList.x[i] * size, aliveList.y[i] * size, size,
+                         size};
+  }
+  if (rects.empty()) {
+    return true;
+  }
+  SDL_SetRenderDrawColor(renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
+  return SDL_RenderFillRects(renderer, rects.data(),
+                             static_cast<int>(rects.size()));
+}
+
+bool Renderer::drawGeometry(const GameBoard &gameBoard, const int cellSize) {
+  const AliveList &aliveList = gameBoard.aliveList;
+  const float size = static_cast<float>(cellSize);
+  const std::size_t count = aliveList.size();
+  vertices.resize(count * 4);
+  indices.resize(count * 6);
+  for (std::size_t i = 0; i < count; i++) {
+    const float left = aliveList.x[i] * size;
+    const float top = aliveList.y[i] * size;
+    SDL_Vertex *quad = &vertices[i * 4];
+    quad[0] = SDL_Vertex{{left, top}, WHITE, {0, 0}};
+    quad[1] = SDL_Vertex{{left + size, top}, WHITE, {0, 0}};
+    quad[2] = SDL_Vertex{{left + size, top + size}, WHITE, {0, 0}};
+    quad[3] = SDL_Vertex{{left, top + size}, WHITE, {0, 0}};
+    const int base = static_cast<int>(i * 4);
+    int *index = &indices[i * 6];
+    index[0] = base;
+    index[1] = base + 1;
+    index[2] = base + 2;
+    index[3] = base;
+    index[4] = base + 2;
+    index[5] = base + 3;
+  }
+  if (count == 0) {
+    return true;
+  }
+  return SDL_RenderGeometry(renderer, nullptr, vertices.data(),
+                            static_cast<int>(vertices.size()), indices.data(),
+                            static_cast<int>(indices.size()));
+}
+
+// (Re)creates the texture when the board size changes.
+bool Renderer::prepareTexture(const GameBoard &gameBoard) {
+  if (texture != nullptr && textureWidth == gameBoard.width &&
+      textureHeight == gameBoard.height) {
+    return true;
+  }
+  if (texture != nullptr) {
+    SDL_DestroyTexture(texture);
+  }
+  texelsCurrent = false;
+  texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+                              SDL_TEXTUREACCESS_STREAMING, gameBoard.width,
+                              gameBoard.height);
+  if (texture == nullptr) {
+    return false;
+  }
+  SDL_SetTextureScaleMode(texture, SDL_SCALEMODE_NEAREST);
+  SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_NONE);
+  textureWidth = gameBoard.width;
+  textureHeight = gameBoard.height;
+  return true;
+}
+
+bool Renderer::renderTexture(const GameBoard &gameBoard, const int cellSize) {
+  const SDL_FRect target{0.0f, 0.0f,
+                         static_cast<float>(gameBoard.width * cellSize),
+                         static_cast<float>(gameBoard.height * cellSize)};
+  return SDL_RenderTexture(renderer, texture, nullptr, &target);
+}
+
+bool Renderer::drawTexture(const GameBoard &gameBoard, const int cellSize) {
+  if (!prepareTexture(gameBoard)) {
+    return false;
+  }
+  void *pixels = nullptr;
+  int pitch = 0;
+  if (!SDL_LockTexture(texture, nullptr, &pixels, &pitch)) {
+    return false;
+  }
+  texelsCurrent = false;
+  const char *cells = gameBoard.board.data();
+  for (int y = 0; y < gameBoard.height; y++) {
+    auto *row = reinterpret_cast<std::uint32_t *>(static_cast<char *>(pixels) +
+                                                  y * pitch);
+    const char *cellRow = cells + static_cast<std::size_t>(y) * gameBoard.width;
+    for (int x = 0; x < gameBoard.width; x++) {
+      row[x] = (cellRow[x] & ALIVE) ? TEXEL_ALIVE : TEXEL_DEAD;
+    }
+  }
+  SDL_UnlockTexture(texture);
+  return renderTexture(gameBoard, cellSize);
+}
+
+bool Renderer::drawDiff(const GameBoard &gameBoard, const int cellSize) {
+  if (!prepareTexture(gameBoard)) {
+    return false;
+  }
+  const int width = gameBoard.width;
+  const int height = gameBoard.height;
+  const ChangeList &changes = gameBoard.changes;
+  if (!texelsCurrent || changes.full || !changes.enabled) {
+    // Locked pixels are write-only, so a full refresh goes through the
+    // CPU copy that later patches build on.
+    texels.resize(static_cast<std::size_t>(width) * height);
+    for (std::size_t i = 0; i < texels.size(); i++) {
+      texels[i] = (gameBoard.board[i] & ALIVE) ? TEXEL_ALIVE : TEXEL_DEAD;
+    }
+    if (!SDL_UpdateTexture(texture, nullptr, texels.data(),
+                           width * static_cast<int>(sizeof(std::uint32_t)))) {
+      return false;
+    }
+    texelsCurrent = true;
+    return renderTexture(gameBoard, cellSize);
+  }
+
+  const int tilesX = (width + LIFE_TILE_SIZE - 1) / LIFE_TILE_SIZE;
+  const int tilesY = (height + LIFE_TILE_SIZE - 1) / LIFE_TILE_SIZE;
+  dirtyTiles.assign(static_cast<std::size_t>(tilesX) * tilesY, 0);
+  // A cell may be listed as both a birth and a death, so take its state
+  // from the board.
+  for (const CellList *list : {&changes.births, &changes.deaths}) {
+    for (const auto &cell : *list) {
+      const int x = cell.first;
+      const int y = cell.second;
+      texels[y * width + x] = getCellState(gameBoard, x, y) == ALIVE
+                                  ? TEXEL_ALIVE
+                                  : TEXEL_DEAD;
+      dirtyTiles[(y / LIFE_TILE_SIZE) * tilesX + x / LIFE_TILE_SIZE] = 1;
+    }
+  }
+  for (int ty = 0; ty < tilesY; ty++) {
+    for (int tx = 0; tx < tilesX; tx++) {
+      if (!dirtyTiles[ty * tilesX + tx]) {
+        continue;
+      }
+      const SDL_Rect rect{tx * LIFE_TILE_SIZE, ty * LIFE_TILE_SIZE,
+                          std::min(LIFE_TILE_SIZE, width - tx * LIFE_TILE_SIZE),
+                          std::min(LIFE_TILE_SIZE,
+                                   height - ty * LIFE_TILE_SIZE)};
+      if (!SDL_UpdateTexture(texture, &rect,
+                             &texels[rect.y * width + rect.x],
+                             width * static_cast<int>(sizeof(std::uint32_t)))) {
+        return false;
+      }
+    }
+  }
+  return renderTexture(gameBoard, cellSize);
+}
+
+} // namespace life
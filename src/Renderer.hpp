@@ -0,0 +1,78 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include "SDL3/SDL.h"
+#include "life.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace life {
+
+// How live cells are put on screen.
+enum class RenderBackend {
+  // One SDL_RenderPoint per pixel of every live cell. Kept as a baseline.
+  POINTS,
+  // One SDL_RenderFillRects call with a rect per live cell.
+  RECTS,
+  // One SDL_RenderGeometry call with a quad per live cell.
+  GEOMETRY,
+  // The board is written into a streaming texture, one texel per cell, and
+  // scaled up in a single draw.
+  TEXTURE,
+  // Like TEXTURE, but keeps the texture between frames and patches only
+  // the tiles holding cells in the board's change list. Needs change
+  // tracking on the board, and the caller to clearChanges after each draw.
+  DIFF,
+};
+
+const char *renderBackendName(RenderBackend backend);
+// The backend after this one, wrapping around; used by the 'a' key.
+RenderBackend nextRenderBackend(RenderBackend backend);
+
+// Draws a GameBoard's live cells in white onto whatever target the
+// SDL_Renderer has. It neither clears nor presents. The batches and the
+// texture are kept between frames, so steady-state drawing does not
+// allocate.
+class Renderer {
+public:
+  explicit Renderer(SDL_Renderer *renderer,
+                    RenderBackend backend = RenderBackend::RECTS);
+  ~Renderer();
+  Renderer(const Renderer &) = delete;
+  Renderer &operator=(const Renderer &) = delete;
+
+  RenderBackend backend() const { return current; }
+  void setBackend(RenderBackend backend);
+
+  // Each cell covers cellSize x cellSize pixels with (0, 0) at the top left.
+  // Returns false, with SDL_GetError set, if SDL refused a call.
+  bool draw(const GameBoard &gameBoard, int cellSize);
+
+private:
+  SDL_Renderer *renderer;
+  RenderBackend current;
+  std::vector<SDL_FRect> rects;
+  std::vector<SDL_Vertex> vertices;
+  std::vector<int> indices;
+  SDL_Texture *texture = nullptr;
+  int textureWidth = 0;
+  int textureHeight = 0;
+  // CPU copy of the texture for DIFF, patched cell by cell and uploaded a
+  // dirty tile at a time. texelsCurrent is false once anything else has
+  // written the texture.
+  std::vector<std::uint32_t> texels;
+  bool texelsCurrent = false;
+  std::vector<char> dirtyTiles;
+
+  bool drawPoints(const GameBoard &gameBoard, int cellSize);
+  bool drawRects(const GameBoard &gameBoard, int cellSize);
+  bool drawGeometry(const GameBoard &gameBoard, int cellSize);
+  bool drawTexture(const GameBoard &gameBoard, int cellSize);
+  bool drawDiff(const GameBoard &gameBoard, int cellSize);
+  bool prepareTexture(const GameBoard &gameBoard);
+  bool renderTexture(const GameBoard &gameBoard, int cellSize);
+};
+
+} // namespace life
+
+#endif // RENDERER_H
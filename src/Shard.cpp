@@ -0,0 +1,255 @@
+// Shard.cpp
+#include "Shard.hpp"
+
+#include <utility>
+
+namespace life {
+namespace {
+// Offsets of the eight directions, ordered so 7 - d is opposite d.
+constexpr int DIRECTION_X[8] = {0, -1, -1, 1, -1, 1, 1, 0};
+constexpr int DIRECTION_Y[8] = {-1, 0, -1, -1, 1, 1, 0, 1};
+
+struct Span {
+    int begin;
+    int end;
+};
+
+// Along one axis: the tile's cells bordering the neighbour at offset d, or,
+// for the halo, the cells past them. Local coordinates count the halo as 0.
+Span edgeSpan(const int d, const int size, const bool halo) {
+  if (d < 0) {
+    return halo ? Span{0, 1} : Span{1, 2};
+  }
+  if (d > 0) {
+    return halo ? Span{size + 1, size + 2} : Span{size, size + 1};
+  }
+  return Span{1, size + 1};
+}
+} // namespace
+
+bool validLayout(const ShardLayout &layout) {
+  return layout.columns >= 1 && layout.rows >= 1 &&
+         layout.columns <= layout.width && layout.rows <= layout.height &&
+         (layout.boundary == Boundary::DEAD ||
+          layout.boundary == Boundary::TORUS);
+}
+
+int shardNeighbour(const ShardLayout &layout, const int shard, const int dx,
+                   const int dy) {
+  int column = shard % layout.columns + dx;
+  int row = shard / layout.columns + dy;
+  if (layout.boundary == Boundary::TORUS) {
+    column = (column + layout.columns) % layout.columns;
+    row = (row + layout.rows) % layout.rows;
+  } else if (column < 0 || row < 0 || column >= layout.columns ||
+             row >= layout.rows) {
+    return -1;
+  }
+  return row * layout.columns + column;
+}
+
+Shard::Shard(const ShardLayout &layout, const int index,
+             Transport &transport)
+    : layout(layout), index(index), transport(transport) {
+  const int column = index % layout.columns;
+  const int row = index / layout.columns;
+  x0 = layout.columnStart(column);
+  y0 = layout.rowStart(row);
+  width = layout.columnStart(column + 1) - x0;
+  height = layout.rowStart(row + 1) - y0;
+  const std::size_t size =
+      static_cast<std::size_t>(width + 2) * static_cast<std::size_t>(height + 2);
+  cells.assign(size, DEAD);
+  next.assign(size, DEAD);
+  for (int d = 0; d < 8; d++) {
+    neighbours[d] =
+        shardNeighbour(layout, index, DIRECTION_X[d], DIRECTION_Y[d]);
+  }
+  sender = std::thread(&Shard::senderLoop, this);
+}
+
+Shard::~Shard() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_one();
+  sender.join();
+}
+
+void Shard::senderLoop() {
+  std::unique_lock<std::mutex> lock(mutex);
+  for (;;) {
+    wake.wait(lock, [this] { return stopping || round != sentRound; });
+    if (stopping) {
+      return;
+    }
+    lock.unlock();
+    const bool ok = sendEdges();
+    lock.lock();
+    sent = ok;
+    sentRound = round;
+    done.notify_one();
+  }
+}
+
+void Shard::seed(const double density, const std::uint64_t seed) {
+  for (int y = 0; y < height; y++) {
+    seedRow(cells.data() + (y + 1) * (width + 2) + 1, layout.width, y0 + y,
+            x0, x0 + width, density, seed);
+  }
+}
+
+char Shard::getCellState(const int x, const int y) const {
+  if (x < x0 || y < y0 || x >= x0 + width || y >= y0 + height) {
+    return DEAD;
+  }
+  return cells[(y - y0 + 1) * (width + 2) + x - x0 + 1];
+}
+
+void Shard::setCellState(const int x, const int y, const char state) {
+  if (x < x0 || y < y0 || x >= x0 + width || y >= y0 + height) {
+    return;
+  }
+  cells[(y - y0 + 1) * (width + 2) + x - x0 + 1] = state;
+}
+
+std::size_t Shard::population() const {
+  std::size_t count = 0;
+  for (int y = 1; y <= height; y++) {
+    const char *row = cells.data() + y * (width + 2);
+    for (int x = 1; x <= width; x++) {
+      count += row[x];
+    }
+  }
+  return count;
+}
+
+std::vector<char> Shard::tile() const {
+  std::vector<char> alive;
+  alive.reserve(static_cast<std::size_t>(width) * height);
+  for (int y = 1; y <= height; y++) {
+    const char *row = cells.data() + y * (width + 2);
+    alive.insert(alive.end(), row + 1, row + width + 1);
+  }
+  return alive;
+}
+
+// Edges travel one bit per cell, row by row.
+void Shard::packEdge(const int direction, std::vector<std::uint8_t> &bits) const {
+  const Span xs = edgeSpan(DIRECTION_X[direction], width, false);
+  const Span ys = edgeSpan(DIRECTION_Y[direction], height, false);
+  bits.assign(((xs.end - xs.begin) * (ys.end - ys.begin) + 7) / 8, 0);
+  int bit = 0;
+  for (int y = ys.begin; y < ys.end; y++) {
+    for (int x = xs.begin; x < xs.end; x++, bit++) {
+      if (cells[y * (width + 2) + x]) {
+        bits[bit / 8] |= static_cast<std::uint8_t>(1u << (bit % 8));
+      }
+    }
+  }
+}
+
+void Shard::unpackHalo(const int direction,
+                       const std::vector<std::uint8_t> &bits) {
+  const Span xs = edgeSpan(DIRECTION_X[direction], width, true);
+  const Span ys = edgeSpan(DIRECTION_Y[direction], height, true);
+  int bit = 0;
+  for (int y = ys.begin; y < ys.end; y++) {
+    for (int x = xs.begin; x < xs.end; x++, bit++) {
+      cells[y * (width + 2) + x] =
+          static_cast<char>((bits[bit / 8] >> (bit % 8)) & 1);
+    }
+  }
+}
+
+bool Shard::sendEdges() {
+  for (int d = 0; d < 8; d++) {
+    if (neighbours[d] < 0 || neighbours[d] == index) {
+      continue;
+    }
+    packEdge(d, outgoing[d]);
+    if (!transport.send(neighbours[d], outgoing[d].data(),
+                        outgoing[d].size())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// What a neighbour sends in direction d fills the halo on its side of this
+// tile, 7 - d. Taking them in direction order takes each neighbour's in the
+// order it sent them, even when one neighbour lies in several directions.
+bool Shard::receiveHalo() {
+  for (int d = 0; d < 8; d++) {
+    const int source = neighbours[7 - d];
+    if (source < 0) {
+      continue;
+    }
+    if (source == index) {
+      // A torus one tile across borders itself.
+      packEdge(d, incoming);
+    } else {
+      const Span xs = edgeSpan(DIRECTION_X[d], width, false);
+      const Span ys = edgeSpan(DIRECTION_Y[d], height, false);
+      incoming.resize(((xs.end - xs.begin) * (ys.end - ys.begin) + 7) / 8);
+      if (!transport.receive(source, incoming.data(), incoming.size())) {
+        return false;
+      }
+    }
+    unpackHalo(7 - d, incoming);
+  }
+  return true;
+}
+
+void Shard::stepCells(const int row0, const int row1, const int column0,
+                      const int column1) {
+  const std::uint32_t nextAlive =
+      packedRuleMask(layout.rule.birth, layout.rule.survive);
+  const int stride = width + 2;
+  for (int y = row0; y < row1; y++) {
+    const char *up = cells.data() + (y - 1) * stride;
+    const char *row = cells.data() + y * stride;
+    const char *down = cells.data() + (y + 1) * stride;
+    char *out = next.data() + y * stride;
+    for (int x = column0; x < column1; x++) {
+      const int count = up[x - 1] + up[x] + up[x + 1] + row[x - 1] +
+                        row[x + 1] + down[x - 1] + down[x] + down[x + 1];
+      out[x] = static_cast<char>((nextAlive >> ((count << 1) | row[x])) & 1);
+    }
+  }
+}
+
+bool Shard::step() {
+  // The sender reads only the tile, and this thread writes only next and
+  // the halo, so they share cells safely.
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    round++;
+  }
+  wake.notify_one();
+  stepCells(2, height, 2, width);
+  const bool received = receiveHalo();
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return sentRound == round; });
+    if (!sent || !received) {
+      return false;
+    }
+  }
+  // The ring along the tile's edge: top and bottom rows whole, then the
+  // first and last column between them.
+  stepCells(1, 2, 1, width + 1);
+  if (height > 1) {
+    stepCells(height, height + 1, 1, width + 1);
+  }
+  stepCells(2, height, 1, 2);
+  if (width > 1) {
+    stepCells(2, height, width, width + 1);
+  }
+  std::swap(cells, next);
+  generations++;
+  return true;
+}
+
+} // namespace life
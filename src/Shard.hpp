@@ -0,0 +1,123 @@
+#ifndef SHARD_H
+#define SHARD_H
+
+#include "Transport.hpp"
+#include "life.hpp"
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace life {
+
+// How a board too big for one process splits into columns x rows tiles,
+// one per shard, numbered row by row. Tile edges fall as the parallel step
+// splits its bands, so tiles differ in size by at most a cell.
+struct ShardLayout {
+    int width = LIFE_BOARD_WIDTH;
+    int height = LIFE_BOARD_HEIGHT;
+    int columns = 1;
+    int rows = 1;
+    Rule rule = CONWAY;
+    Boundary boundary = Boundary::DEAD;
+
+    int shards() const { return columns * rows; }
+    int columnStart(int column) const {
+        return static_cast<int>(static_cast<long long>(width) * column /
+                                columns);
+    }
+    int rowStart(int row) const {
+        return static_cast<int>(static_cast<long long>(height) * row / rows);
+    }
+};
+
+// Whether every tile has at least one cell and the boundary is one shards
+// can step: dead or a torus. A Klein bottle would pair tiles whose edges
+// need not line up.
+bool validLayout(const ShardLayout &layout);
+// The shard whose tile lies dx, dy tiles from shard's, wrapping on a
+// torus, or -1 past a dead edge.
+int shardNeighbour(const ShardLayout &layout, int shard, int dx, int dy);
+
+// One tile of a sharded board, stepped in lockstep with the shards around
+// it. Each generation a shard sends its edge rows, columns and corners to
+// its eight neighbours and receives theirs into a one-cell halo around its
+// tile, so its cells step as they would on the whole board. The edges go
+// out on the shard's sender thread while the interior, which needs no
+// halo, is stepped; only the ring of cells along the tile's edge waits for
+// the halo. The sender lives as long as the shard, so nothing is spawned
+// per generation.
+class Shard {
+private:
+  ShardLayout layout;
+  int index;
+  Transport &transport;
+  // The tile: cells [x0, x0 + width) x [y0, y0 + height) of the board.
+  int x0;
+  int y0;
+  int width;
+  int height;
+  // Bare alive bits, (height + 2) rows of (width + 2), the tile inside a
+  // ring of halo cells. Halo cells past a dead edge stay dead.
+  std::vector<char> cells;
+  std::vector<char> next;
+  // The shard in each direction, or -1; direction 7 - d is opposite d.
+  std::array<int, 8> neighbours;
+  std::array<std::vector<std::uint8_t>, 8> outgoing;
+  std::vector<std::uint8_t> incoming;
+  std::uint64_t generations = 0;
+
+  // The sender thread sends the edges once round moves past sentRound.
+  // Guarded by mutex.
+  std::thread sender;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable done;
+  std::uint64_t round = 0;
+  std::uint64_t sentRound = 0;
+  bool sent = true;
+  bool stopping = false;
+
+  void senderLoop();
+  void packEdge(int direction, std::vector<std::uint8_t> &bits) const;
+  void unpackHalo(int direction, const std::vector<std::uint8_t> &bits);
+  bool sendEdges();
+  bool receiveHalo();
+  // Steps local rows [row0, row1) and columns [column0, column1) into next.
+  void stepCells(int row0, int row1, int column0, int column1);
+
+public:
+  // layout must be valid, and transport must reach every neighbour by its
+  // shard number. The tile starts dead.
+  Shard(const ShardLayout &layout, int index, Transport &transport);
+  ~Shard();
+  Shard(const Shard &) = delete;
+  Shard &operator=(const Shard &) = delete;
+
+  // Fills the tile as seedBoard(board, density, seed) fills the board.
+  void seed(double density, std::uint64_t seed);
+  // Cells are addressed in board coordinates; those outside the tile read
+  // dead and are not written.
+  char getCellState(int x, int y) const;
+  void setCellState(int x, int y, char state);
+  // Steps one generation. Every shard of the layout must step with it.
+  // Returns false if a neighbour could not be reached, leaving the tile
+  // as it was.
+  bool step();
+
+  std::uint64_t generation() const { return generations; }
+  std::size_t population() const;
+  // The tile's alive bits, row by row.
+  std::vector<char> tile() const;
+  int left() const { return x0; }
+  int top() const { return y0; }
+  int tileWidth() const { return width; }
+  int tileHeight() const { return height; }
+};
+
+} // namespace life
+
+#endif // SHARD_H
@@ -0,0 +1,229 @@
+// Simulation.cpp
+#include "Simulation.hpp"
+#include "ThreadPool.hpp"
+
+#include <chrono>
+#include <memory>
+#include <utility>
+
+namespace life {
+
+Simulation::Simulation(GameBoard board, ThreadPool *pool)
+    : board(std::move(board)), pool(pool) {
+  // The reader always has a frame, even before the thread starts.
+  publish();
+  frames.update();
+  lastSequence = frames.front().sequence;
+}
+
+Simulation::~Simulation() { stop(); }
+
+void Simulation::start() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (running) {
+    return;
+  }
+  running = true;
+  thread = std::thread(&Simulation::run, this);
+}
+
+void Simulation::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    running = false;
+  }
+  wake.notify_all();
+  if (thread.joinable()) {
+    thread.join();
+  }
+}
+
+void Simulation::post(Command command) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.push_back(std::move(command));
+  }
+  wake.notify_all();
+}
+
+void Simulation::restore(GameBoard replacement, const std::uint64_t generation) {
+  // The command runs on the simulation thread, the only writer of
+  // generationCount.
+  auto shared = std::make_shared<GameBoard>(std::move(replacement));
+  post([this, shared, generation](GameBoard &gameBoard) {
+    const bool tracking = gameBoard.changes.enabled;
+    gameBoard = std::move(*shared);
+    trackChanges(gameBoard, tracking);
+    gameBoard.changes.full = true;
+    generationCount = generation;
+  });
+}
+
+void Simulation::setPaused(const bool pause) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    paused = pause;
+  }
+  wake.notify_all();
+}
+
+bool Simulation::isPaused() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return paused;
+}
+
+void Simulation::setSparse(const bool enabled) { sparse = enabled; }
+
+void Simulation::recordSteps(Stats &target) {
+  stats = &target;
+  stepTimer = target.registerTimer(ITERATE);
+}
+
+void Simulation::detectCycles(const int maxPeriod) {
+  cycles = CycleDetector(maxPeriod);
+  period = 0;
+}
+
+void Simulation::setTargetRate(const double generationsPerSecond) {
+  {
+    // Under the lock, so a thread about to wait sees the new rate.
+    std::lock_guard<std::mutex> lock(mutex);
+    targetRate = generationsPerSecond;
+  }
+  wake.notify_all();
+}
+
+Frame &Simulation::latestFrame() {
+  frames.update();
+  Frame &frame = frames.front();
+  if (frame.sequence != lastSequence && frame.sequence != lastSequence + 1) {
+    frame.board.changes.full = true;
+  }
+  // A settled board's generations go on without new frames. The second
+  // check drops a count read after the board started changing again.
+  if (settledSequence == frame.sequence) {
+    const std::uint64_t generation = generationCount;
+    if (settledSequence == frame.sequence && generation > frame.generation) {
+      frame.generation = generation;
+    }
+  }
+  lastSequence = frame.sequence;
+  return frame;
+}
+
+bool Simulation::step() {
+  if (cycles.maxPeriod() > 0) {
+    if (!board.hashing) {
+      // Set up on the first step and after a command replaced the board.
+      trackHash(board, true);
+      cycles.reset();
+    }
+    if (cycles.size() == 0) {
+      cycles.record(board.hash);
+    }
+    // A still life's next generation is itself.
+    if (cycles.period() == 1) {
+      generationCount++;
+      return false;
+    }
+  }
+  const auto begin = std::chrono::steady_clock::now();
+  if (sparse) {
+    iterateBoardSparse(board);
+    activeTiles = board.tiles.activeCount;
+  } else if (pool != nullptr) {
+    iterateBoard(board, *pool);
+  } else {
+    iterateBoard(board);
+  }
+  const auto elapsed = static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - begin)
+          .count());
+  stepNanoseconds = elapsed;
+  if (stats != nullptr) {
+    stats->record(stepTimer, elapsed);
+  }
+  generationCount++;
+  if (cycles.maxPeriod() > 0) {
+    period = cycles.record(board.hash);
+  }
+  return true;
+}
+
+void Simulation::publish() {
+  // Copy assignment reuses the slot's buffers, so once every slot has
+  // seen a full-size board publishing does not allocate.
+  Frame &frame = frames.back();
+  frame.board.height = board.height;
+  frame.board.width = board.width;
+  frame.board.board = board.board;
+  frame.board.rule = board.rule;
+  frame.board.boundary = board.boundary;
+  frame.board.aliveList.x = board.aliveList.x;
+  frame.board.aliveList.y = board.aliveList.y;
+  frame.board.changes = board.changes;
+  frame.generation = generationCount;
+  frame.sequence = ++published;
+  frames.publish();
+  clearChanges(board);
+}
+
+void Simulation::run() {
+  using Clock = std::chrono::steady_clock;
+  Clock::time_point deadline = Clock::now();
+  std::unique_lock<std::mutex> lock(mutex);
+  while (running) {
+    applying.swap(pending);
+    const bool stepping = !paused;
+    lock.unlock();
+
+    const bool edited = !applying.empty();
+    if (edited) {
+      // Before the commands, which may set generationCount.
+      settledSequence = 0;
+    }
+    for (Command &command : applying) {
+      command(board);
+    }
+    if (edited) {
+      cycles.reset();
+      period = 0;
+    }
+    applying.clear();
+    const bool changed = stepping && step();
+    if (changed || edited) {
+      settledSequence = 0;
+      publish();
+    } else if (stepping) {
+      settledSequence = published;
+    }
+
+    lock.lock();
+    if (!stepping) {
+      wake.wait(lock, [&] { return !running || !paused || !pending.empty(); });
+      deadline = Clock::now();
+      continue;
+    }
+    const double rate = targetRate;
+    if (rate > 0) {
+      const auto interval = std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double>(1.0 / rate));
+      deadline += interval;
+      // After a stall, start over rather than rushing to catch up.
+      if (deadline < Clock::now() - interval) {
+        deadline = Clock::now();
+      }
+      wake.wait_until(lock, deadline, [&] { return !running; });
+    } else if (!changed) {
+      // Settled with no rate to count at: nothing to do until a command,
+      // a pause or a rate arrives.
+      wake.wait(lock, [&] {
+        return !running || paused || !pending.empty() || targetRate > 0;
+      });
+      deadline = Clock::now();
+    }
+  }
+}
+
+} // namespace life
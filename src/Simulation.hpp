@@ -0,0 +1,128 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "CycleDetector.hpp"
+#include "Stats.hpp"
+#include "TripleBuffer.hpp"
+#include "life.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace life {
+
+class ThreadPool;
+
+// A published copy of the board. Only what drawing and saving read is
+// copied: the size, the rule, the boundary, the cells, the alive list's x
+// and y arrays and the change list.
+// The changes are those since the frame with the previous sequence number.
+struct Frame {
+    GameBoard board;
+    std::uint64_t generation = 0;
+    std::uint64_t sequence = 0;
+};
+
+// Steps a board on its own thread, apart from rendering, either as fast as
+// it can or at a target rate. After every generation that changed the
+// cells, or batch of edits, it publishes a Frame through a TripleBuffer;
+// the generations of a settled still life only move the newest frame's
+// generation on. Edits are posted as commands and run on the simulation
+// thread between generations, so a frame never shows half an edit.
+class Simulation {
+public:
+  using Command = std::function<void(GameBoard &)>;
+
+private:
+  GameBoard board;
+  ThreadPool *pool;
+  TripleBuffer<Frame> frames;
+  std::uint64_t published = 0;
+  // Reader side: the sequence of the frame last handed out.
+  std::uint64_t lastSequence = 0;
+
+  std::mutex mutex;
+  std::condition_variable wake;
+  // Guarded by mutex.
+  std::vector<Command> pending;
+  bool running = false;
+  bool paused = false;
+
+  // Scratch for the simulation thread, swapped with pending.
+  std::vector<Command> applying;
+  std::atomic<bool> sparse{false};
+  std::atomic<double> targetRate{0.0};
+  std::atomic<std::uint64_t> generationCount{0};
+  std::atomic<std::uint64_t> stepNanoseconds{0};
+  std::atomic<int> activeTiles{0};
+  // Simulation thread only, but for maxPeriod, which is set before start().
+  CycleDetector cycles{0};
+  std::atomic<int> period{0};
+  // The sequence of the frame the board has settled at, or 0 while it is
+  // changing; generationCount then stands for that frame's generation.
+  std::atomic<std::uint64_t> settledSequence{0};
+  Stats *stats = nullptr;
+  StatId stepTimer = -1;
+  std::thread thread;
+
+  void run();
+  // Returns whether the cells changed.
+  bool step();
+  void publish();
+
+public:
+  // Steps with pool when given, serially otherwise. The pool must outlive
+  // the simulation and not be used by anyone else while it runs.
+  explicit Simulation(GameBoard board, ThreadPool *pool = nullptr);
+  ~Simulation();
+  Simulation(const Simulation &) = delete;
+  Simulation &operator=(const Simulation &) = delete;
+
+  void start();
+  // Finishes the current generation and joins the thread. Commands still
+  // queued are dropped.
+  void stop();
+
+  // Queues a change to the board, run before the next generation.
+  void post(Command command);
+  // Queues replacing the board, and the generation count with it, e.g. to
+  // resume from a snapshot.
+  void restore(GameBoard board, std::uint64_t generation);
+  void setPaused(bool paused);
+  bool isPaused();
+  // Steps with iterateBoardSparse instead of the full-board step.
+  void setSparse(bool sparse);
+  bool isSparse() const { return sparse; }
+  // Generations per second; 0 steps as fast as possible.
+  void setTargetRate(double generationsPerSecond);
+  // Records the duration of every step into an ITERATE timer on stats,
+  // which must outlive the simulation. Call before start().
+  void recordSteps(Stats &stats);
+  // Watches for the board repeating a state of the last maxPeriod
+  // generations, hashing it as it steps; 0 stops watching. Once the board
+  // has settled into a still life, generations are counted without being
+  // stepped or published until the next command, and at an unlimited rate
+  // the thread sleeps instead of counting. Call before start().
+  void detectCycles(int maxPeriod);
+
+  // Reader side, for one thread only. Returns the newest frame. When frames
+  // were skipped since the last call, its changes are marked full, as the
+  // skipped frames' changes are not in its lists.
+  Frame &latestFrame();
+
+  std::uint64_t generation() const { return generationCount; }
+  // Duration of the last step.
+  std::uint64_t lastStepNanoseconds() const { return stepNanoseconds; }
+  // Tiles the last sparse step evaluated.
+  int lastActiveTiles() const { return activeTiles; }
+  // The period the board has settled into, 1 for a still life, or 0.
+  int cyclePeriod() const { return period; }
+};
+
+} // namespace life
+
+#endif // SIMULATION_H
@@ -1,41 +1,175 @@
 // stats.cpp
 #include "Stats.hpp"
+#include <chrono>
 #include <iostream>
 
 namespace life {
 
+int Histogram::bucketOf(const Uint64 value) {
+  if (value < 2 * SUB_BUCKETS) {
+    return static_cast<int>(value);
+  }
+  const int magnitude = 63 - __builtin_clzll(value);
+  const int shift = magnitude - SUB_BITS;
+  return (shift + 1) * SUB_BUCKETS +
+         static_cast<int>((value >> shift) - SUB_BUCKETS);
+}
+
+Uint64 Histogram::bucketTop(const int bucket) {
+  if (bucket < 2 * SUB_BUCKETS) {
+    return static_cast<Uint64>(bucket);
+  }
+  const int shift = bucket / SUB_BUCKETS - 1;
+  const Uint64 base =
+      static_cast<Uint64>(bucket % SUB_BUCKETS + SUB_BUCKETS) << shift;
+  return base + ((Uint64(1) << shift) - 1);
+}
+
+void Histogram::record(const Uint64 value) {
+  buckets[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+  samples.fetch_add(1, std::memory_order_relaxed);
+  total.fetch_add(value, std::memory_order_relaxed);
+  Uint64 seen = largest.load(std::memory_order_relaxed);
+  while (value > seen &&
+         !largest.compare_exchange_weak(seen, value,
+                                        std::memory_order_relaxed)) {
+  }
+}
+
+Uint64 Histogram::mean() const {
+  const Uint64 n = count();
+  return n == 0 ? 0 : total.load(std::memory_order_relaxed) / n;
+}
+
+Uint64 Histogram::percentile(const double fraction) const {
+  const Uint64 n = count();
+  if (n == 0) {
+    return 0;
+  }
+  // The rank of the sample wanted, counting from 1.
+  Uint64 rank = static_cast<Uint64>(fraction * static_cast<double>(n) + 0.5);
+  rank = rank < 1 ? 1 : (rank > n ? n : rank);
+  Uint64 seen = 0;
+  for (int bucket = 0; bucket < BUCKETS; bucket++) {
+    seen += buckets[bucket].load(std::memory_order_relaxed);
+    if (seen >= rank) {
+      // The bucket's top can overshoot the largest sample seen.
+      const Uint64 top = bucketTop(bucket);
+      return top < max() ? top : max();
+    }
+  }
+  return max();
+}
+
 void Stats::start(const std::string_view &name, const Uint64 time) {
-  counters[name].start = time;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto found = counters.find(name);
+  if (found == counters.end()) {
+    found = counters.emplace(std::string(name), stat()).first;
+  }
+  found->second.start = time;
 }
 
 void Stats::stop(const std::string_view &name, const Uint64 time) {
-  counters[name].stop = time;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto found = counters.find(name);
+  if (found == counters.end()) {
+    found = counters.emplace(std::string(name), stat()).first;
+  }
+  found->second.stop = time;
 }
 
 void Stats::set(const std::string_view &name, const Uint64 value) {
-  values[name] = value;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto found = values.find(name);
+  if (found == values.end()) {
+    values.emplace(std::string(name), value);
+  } else {
+    found->second = value;
+  }
 }
 
-// A basic print implementation for testing purposes.
-// This version directly calculates stop - start.
-// If start > stop (e.g., stop not called, so stop=0), Uint64 will underflow.
+StatId Stats::registerTimer(const std::string_view name) {
+  std::lock_guard<std::mutex> lock(mutex);
+  const int count = timerCount.load(std::memory_order_relaxed);
+  for (int id = 0; id < count; id++) {
+    if (timers[id]->name == name) {
+      return id;
+    }
+  }
+  if (count == MAX_TIMERS) {
+    return -1;
+  }
+  timers[count] = std::make_unique<Timer>();
+  timers[count]->name = std::string(name);
+  timerCount.store(count + 1, std::memory_order_release);
+  return count;
+}
+
+void Stats::record(const StatId id, const Uint64 nanoseconds) {
+  if (id >= 0 && id < timerCount.load(std::memory_order_acquire)) {
+    timers[id]->histogram.record(nanoseconds);
+  }
+}
+
+const Histogram &Stats::histogram(const StatId id) const {
+  return timers[id]->histogram;
+}
+
+std::vector<std::pair<std::string, Uint64>> Stats::valueSnapshot() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return {values.begin(), values.end()};
+}
+
+std::vector<TimerSummary> Stats::timerSnapshot() const {
+  std::vector<TimerSummary> summaries;
+  const int count = timerCount.load(std::memory_order_acquire);
+  for (int id = 0; id < count; id++) {
+    const Histogram &h = timers[id]->histogram;
+    TimerSummary summary;
+    summary.name = timers[id]->name;
+    summary.count = h.count();
+    summary.p50 = h.percentile(0.50);
+    summary.p99 = h.percentile(0.99);
+    summary.max = h.max();
+    summary.mean = h.mean();
+    summaries.push_back(std::move(summary));
+  }
+  return summaries;
+}
+
+Uint64 Stats::now() {
+  return static_cast<Uint64>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+
+// The legacy counters print stop - start. If start > stop (e.g., stop not
+// called, so stop=0), Uint64 will underflow.
 void Stats::print(std::ostream &out) const {
+  std::lock_guard<std::mutex> lock(mutex);
   out << "Statistics:" << std::endl;
-  if (counters.empty()) {
-    // Optionally, print a message if no stats, or just the header.
-    // For these tests, we'll assume it just prints the header if empty.
-    return;
-  }
   for (const auto &pair : counters) {
-    const std::string_view &name = pair.first;
+    const std::string &name = pair.first;
     const stat &s = pair.second;
     out << name << ": " << (s.stop - s.start) << " ms" << std::endl;
   }
   for (const auto &pair : values) {
-    const std::string_view &name = pair.first;
+    const std::string &name = pair.first;
     const Uint64 &v = pair.second;
     out << name << ": " << v << std::endl;
   }
+  const int count = timerCount.load(std::memory_order_acquire);
+  for (int id = 0; id < count; id++) {
+    const Histogram &h = timers[id]->histogram;
+    if (h.count() == 0) {
+      continue;
+    }
+    out << timers[id]->name << ": n=" << h.count()
+        << " p50=" << h.percentile(0.50) << " ns p99=" << h.percentile(0.99)
+        << " ns max=" << h.max() << " ns" << std::endl;
+  }
 }
 
 } // namespace life
@@ -2,9 +2,16 @@
 #define STATS_H
 
 #include "SDL3/SDL_stdinc.h"
+#include <array>
+#include <atomic>
+#include <functional>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <string_view>
+#include <vector>
 
 namespace life {
 
@@ -13,6 +20,54 @@ constexpr std::string_view RENDER = "Render";
 constexpr std::string_view PRESENT = "Present";
 constexpr std::string_view CALL = "Call";
 constexpr std::string_view FRAMERATE = "Frame Rate";
+constexpr std::string_view ACTIVE_TILES = "Active Tiles";
+constexpr std::string_view GENERATION = "Generation";
+constexpr std::string_view POPULATION = "Population";
+// The period the board has settled into, 0 while it has not.
+constexpr std::string_view PERIOD = "Period";
+
+// Index of a timer returned by Stats::registerTimer.
+using StatId = int;
+
+// Log-linear histogram of nanosecond samples in the style of HdrHistogram:
+// values below 64 get a bucket each, and every power of two above that is
+// split into 32 buckets, so any value is reported to within about 3%.
+// Recording is a handful of relaxed atomic adds, safe from any thread.
+class Histogram {
+private:
+  static constexpr int SUB_BITS = 5;
+  static constexpr int SUB_BUCKETS = 1 << SUB_BITS;
+  // Two linear runs below 64, then one run per magnitude up to 2^63.
+  static constexpr int BUCKETS = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+
+  std::array<std::atomic<Uint64>, BUCKETS> buckets{};
+  std::atomic<Uint64> samples{0};
+  std::atomic<Uint64> total{0};
+  std::atomic<Uint64> largest{0};
+
+  static int bucketOf(Uint64 value);
+  // The largest value that falls into the bucket.
+  static Uint64 bucketTop(int bucket);
+
+public:
+  void record(Uint64 value);
+  Uint64 count() const { return samples.load(std::memory_order_relaxed); }
+  Uint64 max() const { return largest.load(std::memory_order_relaxed); }
+  Uint64 mean() const;
+  // The value at or below which the given fraction of samples fall, e.g.
+  // 0.99 for p99; 0 when empty.
+  Uint64 percentile(double fraction) const;
+};
+
+// A timer's histogram reduced to the figures that get reported.
+struct TimerSummary {
+  std::string name;
+  Uint64 count = 0;
+  Uint64 p50 = 0;
+  Uint64 p99 = 0;
+  Uint64 max = 0;
+  Uint64 mean = 0;
+};
 
 class Stats {
 private:
@@ -21,16 +76,68 @@ private:
     Uint64 stop = 0;
   };
 
-  std::map<std::string_view, stat> counters;
-  std::map<std::string_view, Uint64> values;
+  struct Timer {
+    std::string name;
+    Histogram histogram;
+  };
+
+  static constexpr int MAX_TIMERS = 32;
+
+  // The legacy string-keyed API, guarded by mutex. The maps own their keys
+  // and look them up by string_view.
+  mutable std::mutex mutex;
+  std::map<std::string, stat, std::less<>> counters;
+  std::map<std::string, Uint64, std::less<>> values;
+
+  // Slots are filled by registerTimer under mutex and never move, so
+  // recording by id needs no lock.
+  std::array<std::unique_ptr<Timer>, MAX_TIMERS> timers;
+  std::atomic<int> timerCount{0};
 
 public:
+  // Millisecond start/stop pairs and plain values by name. Kept for
+  // callers that sample once per frame; each call takes a lock.
   void start(const std::string_view &name, Uint64 time);
   void stop(const std::string_view &name, Uint64 time);
   void set(const std::string_view &name, Uint64 value);
+
+  // Registers a nanosecond timer ahead of the hot path and returns its id.
+  // Registering a name again returns the same id; returns -1 once
+  // MAX_TIMERS are in use.
+  StatId registerTimer(std::string_view name);
+  // Adds a sample to a registered timer; lock-free and safe from any
+  // thread.
+  void record(StatId id, Uint64 nanoseconds);
+  const Histogram &histogram(StatId id) const;
+
+  // Consistent copies for exporters running on another thread. Values
+  // come sorted by name, timers in registration order.
+  std::vector<std::pair<std::string, Uint64>> valueSnapshot() const;
+  std::vector<TimerSummary> timerSnapshot() const;
+
+  // Nanoseconds on a monotonic clock.
+  static Uint64 now();
+
+  // Prints the legacy counters and values, then a count, p50, p99 and max
+  // line for every timer with samples.
   void print(std::ostream &out = std::cout) const;
 };
 
+// Records the time from construction to destruction into a timer.
+class ScopedTimer {
+private:
+  Stats &stats;
+  StatId id;
+  Uint64 begin;
+
+public:
+  ScopedTimer(Stats &stats, StatId id)
+      : stats(stats), id(id), begin(Stats::now()) {}
+  ~ScopedTimer() { stats.record(id, Stats::now() - begin); }
+  ScopedTimer(const ScopedTimer &) = delete;
+  ScopedTimer &operator=(const ScopedTimer &) = delete;
+};
+
 } // namespace life
 
 #endif // STATS_H
@@ -0,0 +1,159 @@
+// Telemetry.cpp
+#include "Telemetry.hpp"
+
+#include <iomanip>
+#include <sstream>
+
+namespace life {
+namespace {
+void writeJsonString(std::ostream &out, const std::string_view text) {
+  out << '"';
+  for (const char c : text) {
+    if (c == '"' || c == '\\') {
+      out << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      out << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+          << static_cast<int>(c) << std::dec << std::setfill(' ');
+    } else {
+      out << c;
+    }
+  }
+  out << '"';
+}
+
+void writeCsvField(std::ostream &out, const std::string_view text) {
+  if (text.find_first_of(",\"\n") == std::string_view::npos) {
+    out << text;
+    return;
+  }
+  out << '"';
+  for (const char c : text) {
+    out << c;
+    if (c == '"') {
+      out << c;
+    }
+  }
+  out << '"';
+}
+} // namespace
+
+TelemetryFormat telemetryFormatFor(const std::string_view path) {
+  const std::string_view csv = ".csv";
+  if (path.size() >= csv.size() &&
+      path.substr(path.size() - csv.size()) == csv) {
+    return TelemetryFormat::CSV;
+  }
+  return TelemetryFormat::JSONL;
+}
+
+Telemetry::Telemetry(Stats &stats, std::ostream &out,
+                     const TelemetryFormat format,
+                     const std::chrono::milliseconds interval)
+    : stats(stats), out(out), format(format), interval(interval),
+      created(std::chrono::steady_clock::now()) {}
+
+Telemetry::~Telemetry() { stop(); }
+
+void Telemetry::start() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (running) {
+    return;
+  }
+  running = true;
+  thread = std::thread(&Telemetry::run, this);
+}
+
+void Telemetry::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!running) {
+      return;
+    }
+    running = false;
+  }
+  wake.notify_all();
+  thread.join();
+  writeRecord();
+}
+
+void Telemetry::run() {
+  std::unique_lock<std::mutex> lock(mutex);
+  auto deadline = std::chrono::steady_clock::now() + interval;
+  while (running) {
+    if (wake.wait_until(lock, deadline, [&] { return !running; })) {
+      return;
+    }
+    deadline += interval;
+    lock.unlock();
+    writeRecord();
+    lock.lock();
+  }
+}
+
+void Telemetry::writeRecord() {
+  const auto values = stats.valueSnapshot();
+  const auto timers = stats.timerSnapshot();
+  const double seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - created)
+                             .count();
+  const long long unixMs =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count();
+
+  std::lock_guard<std::mutex> lock(mutex);
+  const double elapsed = seconds - lastSeconds;
+  const auto rateOf = [&](const TimerSummary &timer) {
+    const Uint64 previous = lastCounts[timer.name];
+    return elapsed > 0 ? static_cast<double>(timer.count - previous) / elapsed
+                       : 0.0;
+  };
+
+  // Build the record first so a record is written to the stream whole.
+  std::ostringstream record;
+  record << std::fixed << std::setprecision(3);
+  if (format == TelemetryFormat::JSONL) {
+    record << "{\"time\":" << seconds << ",\"unix_ms\":" << unixMs
+           << ",\"values\":{";
+    for (std::size_t i = 0; i < values.size(); i++) {
+      record << (i ? "," : "");
+      writeJsonString(record, values[i].first);
+      record << ':' << values[i].second;
+    }
+    record << "},\"timers\":{";
+    for (std::size_t i = 0; i < timers.size(); i++) {
+      const TimerSummary &timer = timers[i];
+      record << (i ? "," : "");
+      writeJsonString(record, timer.name);
+      record << ":{\"count\":" << timer.count << ",\"rate\":" << rateOf(timer)
+             << ",\"p50\":" << timer.p50 << ",\"p99\":" << timer.p99
+             << ",\"max\":" << timer.max << ",\"mean\":" << timer.mean << '}';
+    }
+    record << "}}\n";
+  } else {
+    if (!headerWritten) {
+      record << "time,unix_ms,stat,value,count,rate,p50,p99,max,mean\n";
+      headerWritten = true;
+    }
+    for (const auto &value : values) {
+      record << seconds << ',' << unixMs << ',';
+      writeCsvField(record, value.first);
+      record << ',' << value.second << ",,,,,,\n";
+    }
+    for (const TimerSummary &timer : timers) {
+      record << seconds << ',' << unixMs << ',';
+      writeCsvField(record, timer.name);
+      record << ",," << timer.count << ',' << rateOf(timer) << ','
+             << timer.p50 << ',' << timer.p99 << ',' << timer.max << ','
+             << timer.mean << '\n';
+    }
+  }
+  for (const TimerSummary &timer : timers) {
+    lastCounts[timer.name] = timer.count;
+  }
+  lastSeconds = seconds;
+  out << record.str();
+  out.flush();
+}
+
+} // namespace life
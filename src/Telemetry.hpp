@@ -0,0 +1,68 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "Stats.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace life {
+
+enum class TelemetryFormat {
+  // One JSON object per record.
+  JSONL,
+  // One row per value or timer per record, under a single header row.
+  CSV,
+};
+
+// CSV for paths ending in ".csv", JSON lines otherwise.
+TelemetryFormat telemetryFormatFor(std::string_view path);
+
+// Periodically writes a Stats' values and timer summaries to a stream from
+// its own thread, so the render thread never waits on the file or pipe.
+// Each record carries the seconds since the writer was created, the wall
+// clock in Unix milliseconds, every value, and for every timer its count,
+// its samples per second since the previous record (for the Iterate timer,
+// generations per second), p50, p99, max and mean in nanoseconds.
+class Telemetry {
+private:
+  Stats &stats;
+  std::ostream &out;
+  TelemetryFormat format;
+  std::chrono::milliseconds interval;
+  std::chrono::steady_clock::time_point created;
+
+  std::mutex mutex;
+  std::condition_variable wake;
+  bool running = false;
+  std::thread thread;
+
+  // Guarded by mutex: timer counts at the previous record, for rates.
+  std::map<std::string, Uint64> lastCounts;
+  double lastSeconds = 0;
+  bool headerWritten = false;
+
+  void run();
+
+public:
+  Telemetry(Stats &stats, std::ostream &out, TelemetryFormat format,
+            std::chrono::milliseconds interval = std::chrono::seconds(1));
+  // Stops, writing a last record.
+  ~Telemetry();
+  Telemetry(const Telemetry &) = delete;
+  Telemetry &operator=(const Telemetry &) = delete;
+
+  void start();
+  void stop();
+  // Writes one record now and flushes the stream.
+  void writeRecord();
+};
+
+} // namespace life
+
+#endif // TELEMETRY_H
@@ -0,0 +1,76 @@
+// ThreadPool.cpp
+#include "ThreadPool.hpp"
+
+namespace life {
+
+ThreadPool::ThreadPool(int threads) {
+  if (threads <= 0) {
+    threads = static_cast<int>(std::thread::hardware_concurrency());
+  }
+  for (int i = 1; i < threads; i++) {
+    workers.emplace_back(&ThreadPool::workerLoop, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+int ThreadPool::size() const { return static_cast<int>(workers.size()) + 1; }
+
+void ThreadPool::drain(std::unique_lock<std::mutex> &lock) {
+  while (nextTask < taskCount) {
+    const int index = nextTask++;
+    const auto *current = task;
+    lock.unlock();
+    (*current)(index);
+    lock.lock();
+    if (--pending == 0) {
+      done.notify_all();
+    }
+  }
+}
+
+void ThreadPool::workerLoop() {
+  unsigned long seen = 0;
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    wake.wait(lock, [&] { return stopping || batch != seen; });
+    if (stopping) {
+      return;
+    }
+    seen = batch;
+    drain(lock);
+  }
+}
+
+void ThreadPool::run(const int count, const std::function<void(int)> &work) {
+  if (count <= 0) {
+    return;
+  }
+  if (workers.empty() || count == 1) {
+    for (int i = 0; i < count; i++) {
+      work(i);
+    }
+    return;
+  }
+  std::unique_lock<std::mutex> lock(mutex);
+  task = &work;
+  taskCount = count;
+  nextTask = 0;
+  pending = count;
+  batch++;
+  wake.notify_all();
+  drain(lock);
+  done.wait(lock, [&] { return pending == 0; });
+  task = nullptr;
+}
+
+} // namespace life
@@ -0,0 +1,49 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace life {
+
+// A fixed set of worker threads that is created once and reused for every
+// parallel step, so nothing is spawned per frame.
+class ThreadPool {
+private:
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable done;
+
+  // The batch being run, guarded by mutex.
+  const std::function<void(int)> *task = nullptr;
+  int taskCount = 0;
+  int nextTask = 0;
+  int pending = 0;
+  unsigned long batch = 0;
+  bool stopping = false;
+
+  void workerLoop();
+  // Claims and runs tasks of the current batch until none are left.
+  void drain(std::unique_lock<std::mutex> &lock);
+
+public:
+  // threads counts the calling thread, which also runs tasks. 0 picks the
+  // hardware concurrency.
+  explicit ThreadPool(int threads = 0);
+  ~ThreadPool();
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  int size() const;
+  // Runs task(0) .. task(count - 1) across the pool and blocks until all of
+  // them have finished.
+  void run(int count, const std::function<void(int)> &task);
+};
+
+} // namespace life
+
+#endif // THREADPOOL_H
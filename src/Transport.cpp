@@ -0,0 +1,113 @@
+// Transport.cpp
+#include "Transport.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <utility>
+
+namespace life {
+
+SocketTransport::SocketTransport(std::vector<int> sockets)
+    : sockets(std::move(sockets)) {}
+
+SocketTransport::SocketTransport(SocketTransport &&other) noexcept
+    : sockets(std::move(other.sockets)) {
+  other.sockets.clear();
+}
+
+SocketTransport &SocketTransport::operator=(SocketTransport &&other) noexcept {
+  if (this != &other) {
+    for (const int socket : sockets) {
+      if (socket >= 0) {
+        close(socket);
+      }
+    }
+    sockets = std::move(other.sockets);
+    other.sockets.clear();
+  }
+  return *this;
+}
+
+SocketTransport::~SocketTransport() {
+  for (const int socket : sockets) {
+    if (socket >= 0) {
+      close(socket);
+    }
+  }
+}
+
+bool SocketTransport::send(const int peer, const void *data,
+                           const std::size_t size) {
+  if (peer < 0 || peer >= static_cast<int>(sockets.size()) ||
+      sockets[peer] < 0) {
+    return false;
+  }
+  const char *bytes = static_cast<const char *>(data);
+  std::size_t sent = 0;
+  while (sent < size) {
+    // A peer that has gone fails the send rather than raising SIGPIPE.
+    const ssize_t count =
+        ::send(sockets[peer], bytes + sent, size - sent, MSG_NOSIGNAL);
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count <= 0) {
+      return false;
+    }
+    sent += static_cast<std::size_t>(count);
+  }
+  return true;
+}
+
+bool SocketTransport::receive(const int peer, void *data,
+                              const std::size_t size) {
+  if (peer < 0 || peer >= static_cast<int>(sockets.size()) ||
+      sockets[peer] < 0) {
+    return false;
+  }
+  char *bytes = static_cast<char *>(data);
+  std::size_t received = 0;
+  while (received < size) {
+    const ssize_t count =
+        ::recv(sockets[peer], bytes + received, size - received, 0);
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count <= 0) {
+      return false;
+    }
+    received += static_cast<std::size_t>(count);
+  }
+  return true;
+}
+
+std::optional<std::vector<SocketTransport>> connectLocal(const int peers) {
+  std::vector<std::vector<int>> sockets(
+      static_cast<std::size_t>(std::max(0, peers)),
+      std::vector<int>(static_cast<std::size_t>(std::max(0, peers)), -1));
+  bool connected = true;
+  for (int a = 0; a < peers && connected; a++) {
+    for (int b = a + 1; b < peers; b++) {
+      int pair[2];
+      if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0) {
+        connected = false;
+        break;
+      }
+      sockets[a][b] = pair[0];
+      sockets[b][a] = pair[1];
+    }
+  }
+  std::vector<SocketTransport> transports;
+  for (auto &peerSockets : sockets) {
+    transports.emplace_back(std::move(peerSockets));
+  }
+  if (!connected) {
+    // The transports close what was made.
+    return std::nullopt;
+  }
+  return transports;
+}
+
+} // namespace life
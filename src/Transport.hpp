@@ -0,0 +1,54 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace life {
+
+// Carries one shard's messages to and from its peers, numbered from 0.
+// Bytes between two peers arrive in the order they were sent, so a
+// receiver that asks for the messages in the sender's order needs no
+// framing.
+class Transport {
+public:
+  virtual ~Transport() = default;
+
+  // Sends size bytes to peer. Returns false if the peer is gone.
+  virtual bool send(int peer, const void *data, std::size_t size) = 0;
+  // Waits for size bytes from peer. Returns false if the peer is gone.
+  virtual bool receive(int peer, void *data, std::size_t size) = 0;
+};
+
+// A Transport over connected stream sockets, one per peer: socketpairs
+// between threads or forked processes, or Unix domain sockets.
+class SocketTransport : public Transport {
+private:
+  // The socket to each peer, or -1.
+  std::vector<int> sockets;
+
+public:
+  SocketTransport() = default;
+  // Takes ownership of the sockets, indexed by peer.
+  explicit SocketTransport(std::vector<int> sockets);
+  SocketTransport(SocketTransport &&other) noexcept;
+  SocketTransport &operator=(SocketTransport &&other) noexcept;
+  SocketTransport(const SocketTransport &) = delete;
+  SocketTransport &operator=(const SocketTransport &) = delete;
+  // Closes the sockets.
+  ~SocketTransport() override;
+
+  bool send(int peer, const void *data, std::size_t size) override;
+  bool receive(int peer, void *data, std::size_t size) override;
+};
+
+// Transports for peers peers, connected pairwise by socketpairs; element i
+// is peer i's. Each goes to its own thread, or across a fork to its own
+// process, which then drops the others. Returns nothing if the sockets
+// could not be made.
+std::optional<std::vector<SocketTransport>> connectLocal(int peers);
+
+} // namespace life
+
+#endif // TRANSPORT_H
@@ -0,0 +1,53 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace life {
+
+// Hands values from one writer thread to one reader thread without locks
+// or waiting. The writer fills back() and publishes it; the reader picks up
+// the newest published value with update() and reads it through front().
+// Each side owns one of the three slots at any time and the third is
+// passed between them in an atomic, so neither ever sees a value the other
+// is still writing. Values the reader is too slow to pick up are skipped.
+template <typename T> class TripleBuffer {
+private:
+  static constexpr std::uint8_t INDEX = 0x3;
+  // Set in state when its slot was published and not picked up yet.
+  static constexpr std::uint8_t FRESH = 0x4;
+
+  std::array<T, 3> slots{};
+  std::atomic<std::uint8_t> state{1};
+  std::uint8_t writeIndex = 0;
+  std::uint8_t readIndex = 2;
+
+public:
+  // Writer side.
+  T &back() { return slots[writeIndex]; }
+  void publish() {
+    const std::uint8_t previous = state.exchange(
+        static_cast<std::uint8_t>(writeIndex | FRESH), std::memory_order_acq_rel);
+    writeIndex = previous & INDEX;
+  }
+
+  // Reader side. Swaps in the newest published value, if there is one
+  // since the last call, and returns whether it did.
+  bool update() {
+    if ((state.load(std::memory_order_acquire) & FRESH) == 0) {
+      return false;
+    }
+    const std::uint8_t previous =
+        state.exchange(readIndex, std::memory_order_acq_rel);
+    readIndex = previous & INDEX;
+    return true;
+  }
+  T &front() { return slots[readIndex]; }
+  const T &front() const { return slots[readIndex]; }
+};
+
+} // namespace life
+
+#endif // TRIPLEBUFFER_H
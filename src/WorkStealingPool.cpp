@@ -0,0 +1,145 @@
+// WorkStealingPool.cpp
+#include "WorkStealingPool.hpp"
+
+#include <algorithm>
+
+namespace life {
+
+WorkStealingPool::WorkStealingPool(int threads) {
+  if (threads <= 0) {
+    threads = static_cast<int>(std::thread::hardware_concurrency());
+  }
+  threads = std::max(1, threads);
+  shares = std::make_unique<Share[]>(threads);
+  for (int i = 1; i < threads; i++) {
+    workers.emplace_back(&WorkStealingPool::workerLoop, this, i);
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+int WorkStealingPool::size() const {
+  return static_cast<int>(workers.size()) + 1;
+}
+
+bool WorkStealingPool::claim(const int self, int &index) {
+  Share &share = shares[self];
+  std::lock_guard<std::mutex> lock(share.mutex);
+  if (share.begin >= share.end) {
+    return false;
+  }
+  index = share.begin++;
+  return true;
+}
+
+bool WorkStealingPool::steal(const int self) {
+  const int threads = size();
+  for (int i = 1; i < threads; i++) {
+    Share &victim = shares[(self + i) % threads];
+    int begin;
+    int end;
+    {
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (victim.begin >= victim.end) {
+        continue;
+      }
+      // The victim keeps the front, which it is working through.
+      begin = victim.begin + (victim.end - victim.begin) / 2;
+      end = victim.end;
+      victim.end = begin;
+    }
+    Share &share = shares[self];
+    std::lock_guard<std::mutex> lock(share.mutex);
+    share.begin = begin;
+    share.end = end;
+    return true;
+  }
+  return false;
+}
+
+void WorkStealingPool::drain(const int self,
+                             const std::function<void(int)> &current) {
+  while (true) {
+    int index;
+    while (claim(self, index)) {
+      current(index);
+      if (pending.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(mutex);
+        done.notify_all();
+      }
+    }
+    // Tasks are never added mid-batch, so one pass finding every share
+    // empty means there is nothing left to take.
+    if (!steal(self)) {
+      return;
+    }
+  }
+}
+
+void WorkStealingPool::workerLoop(const int self) {
+  unsigned long seen = 0;
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    wake.wait(lock, [&] { return stopping || batch != seen; });
+    if (stopping) {
+      return;
+    }
+    seen = batch;
+    // A worker waking after its batch finished has nothing to join.
+    if (task == nullptr) {
+      continue;
+    }
+    const std::function<void(int)> &current = *task;
+    busy++;
+    lock.unlock();
+    drain(self, current);
+    lock.lock();
+    if (--busy == 0) {
+      done.notify_all();
+    }
+  }
+}
+
+void WorkStealingPool::run(const int count,
+                           const std::function<void(int)> &work) {
+  if (count <= 0) {
+    return;
+  }
+  const int threads = size();
+  if (workers.empty() || count == 1) {
+    for (int i = 0; i < count; i++) {
+      work(i);
+    }
+    return;
+  }
+  for (int i = 0; i < threads; i++) {
+    std::lock_guard<std::mutex> lock(shares[i].mutex);
+    shares[i].begin =
+        static_cast<int>(static_cast<long long>(count) * i / threads);
+    shares[i].end =
+        static_cast<int>(static_cast<long long>(count) * (i + 1) / threads);
+  }
+  pending = count;
+  std::unique_lock<std::mutex> lock(mutex);
+  task = &work;
+  batch++;
+  wake.notify_all();
+  lock.unlock();
+  drain(0, work);
+  lock.lock();
+  // Wait for the workers to leave too, so none is still reading the
+  // shares when the next batch fills them.
+  done.wait(lock, [&] { return pending == 0 && busy == 0; });
+  task = nullptr;
+}
+
+} // namespace life
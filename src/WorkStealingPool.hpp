@@ -0,0 +1,65 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace life {
+
+// Runs batches of independent tasks whose lengths vary widely, such as
+// whole simulations. Each thread starts with its own contiguous share of
+// the batch and works through it front to back; a thread that runs out
+// steals the back half of another's remaining share. Threads only meet on
+// a share's lock when stealing, unlike ThreadPool's single counter, which
+// suits its short, even bands.
+class WorkStealingPool {
+private:
+  // A thread's unclaimed tasks, [begin, end).
+  struct alignas(64) Share {
+    std::mutex mutex;
+    int begin = 0;
+    int end = 0;
+  };
+
+  std::vector<std::thread> workers;
+  std::unique_ptr<Share[]> shares;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable done;
+
+  // The batch being run, guarded by mutex.
+  const std::function<void(int)> *task = nullptr;
+  unsigned long batch = 0;
+  // Workers inside the current batch.
+  int busy = 0;
+  bool stopping = false;
+  std::atomic<int> pending{0};
+
+  void workerLoop(int self);
+  // Runs tasks from share self, then steals, until every share is empty.
+  void drain(int self, const std::function<void(int)> &current);
+  bool claim(int self, int &index);
+  bool steal(int self);
+
+public:
+  // threads counts the calling thread, which also runs tasks. 0 picks the
+  // hardware concurrency.
+  explicit WorkStealingPool(int threads = 0);
+  ~WorkStealingPool();
+  WorkStealingPool(const WorkStealingPool &) = delete;
+  WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+  int size() const;
+  // Runs task(0) .. task(count - 1) across the pool and blocks until all of
+  // them have finished.
+  void run(int count, const std::function<void(int)> &task);
+};
+
+} // namespace life
+
+#endif // WORKSTEALINGPOOL_H
@@ -0,0 +1,227 @@
+// batch.cpp
+#include "./batch.hpp"
+#include "./CycleDetector.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+namespace life {
+namespace {
+std::vector<std::string_view> split(const std::string_view text,
+                                    const char *separators) {
+  std::vector<std::string_view> parts;
+  std::size_t start = 0;
+  while (start < text.size()) {
+    const std::size_t end = text.find_first_of(separators, start);
+    const std::size_t stop = end == std::string_view::npos ? text.size() : end;
+    if (stop > start) {
+      parts.push_back(text.substr(start, stop - start));
+    }
+    start = stop + 1;
+  }
+  return parts;
+}
+
+bool parseUnsigned(const std::string_view text, const std::uint64_t max,
+                   std::uint64_t &value) {
+  const std::string digits(text);
+  if (digits.empty() || digits[0] < '0' || digits[0] > '9') {
+    return false;
+  }
+  char *end = nullptr;
+  errno = 0;
+  const unsigned long long parsed = std::strtoull(digits.c_str(), &end, 10);
+  if (*end != '\0' || errno != 0 || parsed > max) {
+    return false;
+  }
+  value = parsed;
+  return true;
+}
+
+bool parseInt(const std::string_view text, const int min, int &value) {
+  std::uint64_t parsed;
+  if (!parseUnsigned(text, INT_MAX, parsed) ||
+      parsed < static_cast<std::uint64_t>(min)) {
+    return false;
+  }
+  value = static_cast<int>(parsed);
+  return true;
+}
+
+// "N" for a square, or "WxH".
+bool parseSize(const std::string_view text, BatchJob &job) {
+  const std::size_t x = text.find('x');
+  int width;
+  int height;
+  if (x == std::string_view::npos) {
+    if (!parseInt(text, 1, width)) {
+      return false;
+    }
+    height = width;
+  } else if (!parseInt(text.substr(0, x), 1, width) ||
+             !parseInt(text.substr(x + 1), 1, height)) {
+    return false;
+  }
+  // GameBoard indexes its cells with int.
+  if (static_cast<long long>(width) * height > INT_MAX) {
+    return false;
+  }
+  job.width = width;
+  job.height = height;
+  return true;
+}
+
+bool applyValue(BatchJob &job, const std::string_view key,
+                const std::string_view value) {
+  if (key == "size") {
+    return parseSize(value, job);
+  }
+  if (key == "density") {
+    const std::string text(value);
+    char *end = nullptr;
+    const double density = std::strtod(text.c_str(), &end);
+    if (text.empty() || *end != '\0' || !(density >= 0 && density <= 1)) {
+      return false;
+    }
+    job.density = density;
+    return true;
+  }
+  if (key == "rule") {
+    const auto rule = parseRule(value);
+    if (rule) {
+      job.rule = *rule;
+    }
+    return rule.has_value();
+  }
+  if (key == "boundary") {
+    const auto boundary = parseBoundary(value);
+    if (boundary) {
+      job.boundary = *boundary;
+    }
+    return boundary.has_value();
+  }
+  if (key == "seed") {
+    return parseUnsigned(value, UINT64_MAX, job.seed);
+  }
+  if (key == "generations") {
+    return parseUnsigned(value, UINT64_MAX, job.generations);
+  }
+  if (key == "period") {
+    return parseInt(value, 0, job.maxPeriod);
+  }
+  return false;
+}
+
+// Expands one line of key=value lists into its jobs.
+bool parseJobLine(const std::string_view line, std::vector<BatchJob> &jobs) {
+  std::vector<BatchJob> expanded{BatchJob{}};
+  for (const std::string_view pair : split(line, " \t\r")) {
+    const std::size_t equals = pair.find('=');
+    if (equals == std::string_view::npos) {
+      return false;
+    }
+    const std::string_view key = pair.substr(0, equals);
+    const std::vector<std::string_view> values =
+        split(pair.substr(equals + 1), ",");
+    if (values.empty()) {
+      return false;
+    }
+    std::vector<BatchJob> next;
+    next.reserve(expanded.size() * values.size());
+    for (const BatchJob &job : expanded) {
+      for (const std::string_view value : values) {
+        next.push_back(job);
+        if (!applyValue(next.back(), key, value)) {
+          return false;
+        }
+      }
+    }
+    expanded.swap(next);
+  }
+  jobs.insert(jobs.end(), expanded.begin(), expanded.end());
+  return true;
+}
+
+const char *boundaryName(const Boundary boundary) {
+  switch (boundary) {
+  case Boundary::TORUS:
+    return "torus";
+  case Boundary::KLEIN:
+    return "klein";
+  default:
+    return "dead";
+  }
+}
+} // namespace
+
+std::optional<std::vector<BatchJob>> parseJobs(std::istream &in,
+                                               int *errorLine) {
+  std::vector<BatchJob> jobs;
+  std::string line;
+  int number = 0;
+  while (std::getline(in, line)) {
+    number++;
+    const std::size_t first = line.find_first_not_of(" \t\r");
+    if (first == std::string::npos || line[first] == '#') {
+      continue;
+    }
+    if (!parseJobLine(line, jobs)) {
+      if (errorLine != nullptr) {
+        *errorLine = number;
+      }
+      return std::nullopt;
+    }
+  }
+  return jobs;
+}
+
+BatchResult runBoard(GameBoard &board, const std::uint64_t generations,
+                     const int maxPeriod) {
+  const auto start = std::chrono::steady_clock::now();
+  BatchResult result;
+  CycleDetector cycles(maxPeriod);
+  if (maxPeriod > 0) {
+    trackHash(board, true);
+    cycles.record(board.hash);
+  }
+  for (std::uint64_t generation = 1; generation <= generations; generation++) {
+    iterateBoard(board);
+    result.generations = generation;
+    if (maxPeriod > 0 && cycles.record(board.hash) != 0) {
+      result.period = cycles.period();
+      break;
+    }
+  }
+  result.population = board.aliveList.size();
+  result.seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  return result;
+}
+
+BatchResult runJob(const BatchJob &job) {
+  GameBoard board = genBoard(job.height, job.width, job.boundary);
+  setRule(board, job.rule);
+  seedBoard(board, job.density, job.seed);
+  return runBoard(board, job.generations, job.maxPeriod);
+}
+
+void writeResultHeader(std::ostream &out) {
+  out << "job,width,height,rule,boundary,density,seed,generations,"
+         "population,period,gens_per_sec\n";
+}
+
+void writeResult(std::ostream &out, const int index, const BatchJob &job,
+                 const BatchResult &result) {
+  const double rate =
+      result.seconds > 0 ? result.generations / result.seconds : 0.0;
+  out << index << ',' << job.width << ',' << job.height << ','
+      << ruleString(job.rule) << ',' << boundaryName(job.boundary) << ','
+      << job.density << ',' << job.seed << ',' << result.generations << ','
+      << result.population << ',' << result.period << ',' << rate << '\n';
+}
+} // namespace life
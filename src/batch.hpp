@@ -0,0 +1,64 @@
+// batch.hpp
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "life.hpp"
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <vector>
+
+namespace life {
+
+// One independent run of a sweep: a board seeded at random, stepped until
+// it settles or hits the generation limit.
+struct BatchJob {
+    int width = 256;
+    int height = 256;
+    Rule rule = CONWAY;
+    Boundary boundary = Boundary::DEAD;
+    double density = 0.5;
+    std::uint64_t seed = 1;
+    std::uint64_t generations = 10000;
+    // The longest period looked for; 0 runs to the limit without looking.
+    int maxPeriod = 64;
+};
+
+struct BatchResult {
+    // Generations stepped.
+    std::uint64_t generations = 0;
+    std::size_t population = 0;
+    // The period the board settled into, 1 for a still life or an empty
+    // board, 0 if it had not settled by the limit.
+    int period = 0;
+    double seconds = 0;
+};
+
+// A job list has one line per job of space-separated key=value pairs:
+// size (N or WxH), density, rule, boundary, seed, generations and period,
+// each defaulting as in BatchJob. A value may be a comma-separated list,
+// and the line then stands for every combination, so
+// "size=64,128 density=0.25,0.5" is four jobs. Blank lines and lines
+// starting with '#' are skipped. Returns nothing if a line is malformed,
+// setting errorLine to its number when given.
+std::optional<std::vector<BatchJob>> parseJobs(std::istream &in,
+                                               int *errorLine = nullptr);
+
+// Steps board until it repeats a state of the last maxPeriod generations,
+// or for generations. States are compared by the board's Zobrist hash,
+// which the step keeps from the cells that flip; hashing is turned on
+// unless maxPeriod is 0.
+BatchResult runBoard(GameBoard &board, std::uint64_t generations,
+                     int maxPeriod);
+// Builds and seeds the job's board and runs it on the calling thread.
+BatchResult runJob(const BatchJob &job);
+
+// Summaries as CSV: a header, then one row per run with its index in the
+// job list, its parameters and its result, including generations/sec.
+void writeResultHeader(std::ostream &out);
+void writeResult(std::ostream &out, int index, const BatchJob &job,
+                 const BatchResult &result);
+} // namespace life
+
+#endif // BATCH_H
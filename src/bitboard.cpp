@@ -0,0 +1,127 @@
+// bitboard.cpp
+#include "./bitboard.hpp"
+#include "./bitkernel.hpp"
+
+namespace life {
+namespace {
+using Word = std::uint64_t;
+using bitkernel::lifeKernel;
+using bitkernel::ScalarOps;
+using bitkernel::SimdOps;
+
+inline std::size_t rowOffset(const BitBoard &board, const int y) {
+  return static_cast<std::size_t>(y + 1) * board.stride;
+}
+
+// Bits past the right edge of the last word in a row must stay zero, as
+// they are read as the east neighbours of the last column.
+inline Word lastWordMask(const int width) {
+  const int bits = width % 64;
+  return bits == 0 ? ~Word(0) : (Word(1) << bits) - 1;
+}
+
+// Step words [first, last) of one row, LANES words at a time.
+template <typename Ops>
+inline int stepWords(const Word *a, const Word *b, const Word *c, Word *out,
+                     int first, const int last) {
+  for (; first + Ops::LANES <= last; first += Ops::LANES) {
+    const int i = first;
+    Ops::store(out + i,
+               lifeKernel<Ops>(Ops::load(a + i - 1), Ops::load(a + i),
+                               Ops::load(a + i + 1), Ops::load(b + i - 1),
+                               Ops::load(b + i), Ops::load(b + i + 1),
+                               Ops::load(c + i - 1), Ops::load(c + i),
+                               Ops::load(c + i + 1)));
+  }
+  return first;
+}
+} // namespace
+
+BitBoard genBitBoard(const int height, const int width) {
+  BitBoard board;
+  board.height = height;
+  board.width = width;
+  board.stride = (width + 63) / 64 + 2;
+  board.words = BitRow(static_cast<std::size_t>(height + 2) * board.stride, 0);
+  board.nextWords = BitRow(board.words.size(), 0);
+  return board;
+}
+
+char getCellState(const BitBoard &board, const int x, const int y) {
+  const Word word = board.words[rowOffset(board, y) + 1 + x / 64];
+  return static_cast<char>((word >> (x % 64)) & 1);
+}
+
+void setCellState(BitBoard &board, const int x, const int y, char state) {
+  Word &word = board.words[rowOffset(board, y) + 1 + x / 64];
+  const Word bit = Word(1) << (x % 64);
+  word = state == ALIVE ? (word | bit) : (word & ~bit);
+}
+
+int neighborCount(const BitBoard &board, const int x, const int y) {
+  int count = 0;
+  for (int j = y - 1; j <= y + 1; j++) {
+    for (int i = x - 1; i <= x + 1; i++) {
+      if ((i != x || j != y) && i >= 0 && j >= 0 && i < board.width &&
+          j < board.height) {
+        count += getCellState(board, i, j);
+      }
+    }
+  }
+  return count;
+}
+
+void iterateBoard(BitBoard &board) {
+  const int words = board.stride - 2;
+  const Word mask = lastWordMask(board.width);
+  const Word *src = board.words.data();
+  Word *dst = board.nextWords.data();
+  for (int y = 0; y < board.height; y++) {
+    const std::size_t row = rowOffset(board, y);
+    const Word *a = src + row - board.stride;
+    const Word *b = src + row;
+    const Word *c = src + row + board.stride;
+    Word *out = dst + row;
+    int i = stepWords<SimdOps>(a, b, c, out, 1, words + 1);
+    stepWords<ScalarOps>(a, b, c, out, i, words + 1);
+    out[words] &= mask;
+  }
+  board.words.swap(board.nextWords);
+}
+
+std::uint64_t population(const BitBoard &board) {
+  std::uint64_t count = 0;
+  for (const Word word : board.words) {
+    count += static_cast<std::uint64_t>(__builtin_popcountll(word));
+  }
+  return count;
+}
+
+BitBoard toBitBoard(const GameBoard &gameBoard) {
+  BitBoard board = genBitBoard(gameBoard.height, gameBoard.width);
+  for (int y = 0; y < gameBoard.height; y++) {
+    for (int x = 0; x < gameBoard.width; x++) {
+      if (getCellState(gameBoard, x, y) == ALIVE) {
+        setCellState(board, x, y, ALIVE);
+      }
+    }
+  }
+  return board;
+}
+
+GameBoard toGameBoard(const BitBoard &board) {
+  GameBoard gameBoard = genBoard(board.height, board.width);
+  const int words = board.stride - 2;
+  for (int y = 0; y < board.height; y++) {
+    const Word *row = board.words.data() + rowOffset(board, y) + 1;
+    for (int i = 0; i < words; i++) {
+      for (Word word = row[i]; word != 0; word &= word - 1) {
+        setCellState(gameBoard, i * 64 + __builtin_ctzll(word), y, ALIVE);
+      }
+    }
+  }
+  return gameBoard;
+}
+
+const char *bitBoardBackend() { return bitkernel::BACKEND; }
+} // namespace life
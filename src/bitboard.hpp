@@ -0,0 +1,42 @@
+// bitboard.hpp
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include "life.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace life {
+
+using BitRow = std::vector<std::uint64_t>;
+
+// One bit per cell, 64 cells per word. Each row is framed by a zero guard
+// word on either side and the grid by a zero guard row above and below, so
+// the stepping kernel never needs an edge check. Cells outside the board
+// are dead, exactly as with GameBoard. Steps Conway's rule only.
+struct BitBoard {
+    BitRow words;
+    int height;
+    int width;
+    // Words per row including the two guard words.
+    int stride;
+    // Back buffer for iterateBoard, swapped with words every generation.
+    BitRow nextWords;
+};
+
+BitBoard genBitBoard(int height = LIFE_BOARD_HEIGHT, int width = LIFE_BOARD_WIDTH);
+int neighborCount(const BitBoard &board, int x, int y);
+char getCellState(const BitBoard &board, int x, int y);
+void setCellState(BitBoard &board, int x, int y, char state);
+void iterateBoard(BitBoard &board);
+std::uint64_t population(const BitBoard &board);
+
+// Conversions to and from the byte encoding, used to cross-check engines.
+BitBoard toBitBoard(const GameBoard &gameBoard);
+GameBoard toGameBoard(const BitBoard &board);
+
+// "avx2", "sse2" or "scalar", whichever iterateBoard was compiled for.
+const char *bitBoardBackend();
+} // namespace life
+
+#endif // BITBOARD_H
@@ -0,0 +1,125 @@
+// bitkernel.hpp
+// The bit-sliced stepping kernel shared by the bit-packed boards. Internal
+// to the life library.
+#ifndef BITKERNEL_H
+#define BITKERNEL_H
+
+#include <cstdint>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace life {
+namespace bitkernel {
+using Word = std::uint64_t;
+
+// Bit-sliced Conway step for one lane of words. a, b and c are the rows
+// above, at and below the cells being stepped, each given as the word to
+// the west (p), the word itself and the word to the east (n). The eight
+// neighbour bits are summed with full adders into a binary count s2 s1 s0
+// (a count of 8 wraps to 0 and is dead either way).
+template <typename Ops>
+inline typename Ops::V lifeKernel(typename Ops::V ap, typename Ops::V a,
+                                  typename Ops::V an, typename Ops::V bp,
+                                  typename Ops::V b, typename Ops::V bn,
+                                  typename Ops::V cp, typename Ops::V c,
+                                  typename Ops::V cn) {
+  using V = typename Ops::V;
+  // Cell x - 1 moved into bit x, and cell x + 1 moved into bit x.
+  const V aw = Ops::orV(Ops::shl1(a), Ops::shr63(ap));
+  const V ae = Ops::orV(Ops::shr1(a), Ops::shl63(an));
+  const V bw = Ops::orV(Ops::shl1(b), Ops::shr63(bp));
+  const V be = Ops::orV(Ops::shr1(b), Ops::shl63(bn));
+  const V cw = Ops::orV(Ops::shl1(c), Ops::shr63(cp));
+  const V ce = Ops::orV(Ops::shr1(c), Ops::shl63(cn));
+
+  // Row above and row below, three cells each: 2-bit sums.
+  const V u0 = Ops::xorV(Ops::xorV(aw, a), ae);
+  const V u1 = Ops::orV(Ops::andV(aw, a), Ops::andV(ae, Ops::xorV(aw, a)));
+  const V d0 = Ops::xorV(Ops::xorV(cw, c), ce);
+  const V d1 = Ops::orV(Ops::andV(cw, c), Ops::andV(ce, Ops::xorV(cw, c)));
+  // Own row, two cells: 2-bit sum.
+  const V m0 = Ops::xorV(bw, be);
+  const V m1 = Ops::andV(bw, be);
+
+  // t = u + d, 3 bits.
+  const V t0 = Ops::xorV(u0, d0);
+  const V k0 = Ops::andV(u0, d0);
+  const V t1 = Ops::xorV(Ops::xorV(u1, d1), k0);
+  const V t2 = Ops::orV(Ops::andV(u1, d1), Ops::andV(k0, Ops::xorV(u1, d1)));
+  // s = t + m, 3 bits.
+  const V s0 = Ops::xorV(t0, m0);
+  const V j0 = Ops::andV(t0, m0);
+  const V s1 = Ops::xorV(Ops::xorV(t1, m1), j0);
+  const V j1 = Ops::orV(Ops::andV(t1, m1), Ops::andV(j0, Ops::xorV(t1, m1)));
+  const V s2 = Ops::xorV(t2, j1);
+
+  // Alive next with a count of 3, or a count of 2 when alive now.
+  return Ops::andNot(s2, Ops::andV(s1, Ops::orV(s0, b)));
+}
+
+struct ScalarOps {
+  using V = Word;
+  static constexpr int LANES = 1;
+  static V load(const Word *p) { return *p; }
+  static void store(Word *p, V v) { *p = v; }
+  static V shl1(V v) { return v << 1; }
+  static V shr1(V v) { return v >> 1; }
+  static V shl63(V v) { return v << 63; }
+  static V shr63(V v) { return v >> 63; }
+  static V andV(V x, V y) { return x & y; }
+  static V orV(V x, V y) { return x | y; }
+  static V xorV(V x, V y) { return x ^ y; }
+  // ~x & y
+  static V andNot(V x, V y) { return ~x & y; }
+};
+
+#if defined(__AVX2__)
+struct SimdOps {
+  using V = __m256i;
+  static constexpr int LANES = 4;
+  static V load(const Word *p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+  }
+  static void store(Word *p, V v) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v);
+  }
+  static V shl1(V v) { return _mm256_slli_epi64(v, 1); }
+  static V shr1(V v) { return _mm256_srli_epi64(v, 1); }
+  static V shl63(V v) { return _mm256_slli_epi64(v, 63); }
+  static V shr63(V v) { return _mm256_srli_epi64(v, 63); }
+  static V andV(V x, V y) { return _mm256_and_si256(x, y); }
+  static V orV(V x, V y) { return _mm256_or_si256(x, y); }
+  static V xorV(V x, V y) { return _mm256_xor_si256(x, y); }
+  static V andNot(V x, V y) { return _mm256_andnot_si256(x, y); }
+};
+inline constexpr const char *BACKEND = "avx2";
+#elif defined(__SSE2__)
+struct SimdOps {
+  using V = __m128i;
+  static constexpr int LANES = 2;
+  static V load(const Word *p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+  }
+  static void store(Word *p, V v) {
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v);
+  }
+  static V shl1(V v) { return _mm_slli_epi64(v, 1); }
+  static V shr1(V v) { return _mm_srli_epi64(v, 1); }
+  static V shl63(V v) { return _mm_slli_epi64(v, 63); }
+  static V shr63(V v) { return _mm_srli_epi64(v, 63); }
+  static V andV(V x, V y) { return _mm_and_si128(x, y); }
+  static V orV(V x, V y) { return _mm_or_si128(x, y); }
+  static V xorV(V x, V y) { return _mm_xor_si128(x, y); }
+  static V andNot(V x, V y) { return _mm_andnot_si128(x, y); }
+};
+inline constexpr const char *BACKEND = "sse2";
+#else
+using SimdOps = ScalarOps;
+inline constexpr const char *BACKEND = "scalar";
+#endif
+} // namespace bitkernel
+} // namespace life
+
+#endif // BITKERNEL_H
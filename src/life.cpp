@@ -1,17 +1,363 @@
 // life.cpp
 #include "./life.hpp"
+#include "./ThreadPool.hpp"
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 
 using namespace std;
 
 namespace life {
-GameBoard genBoard(int height, int width) {
+namespace {
+// The rule applied by the kernels: the next state of a packed cell
+// (neighbour count << 1) | alive is bit `cell` of a packedRuleMask. For
+// Conway that mask is 0xE0: survive on 5 (two neighbours, alive), and be
+// born or survive on 6 and 7 (three neighbours).
+template <typename R> struct StaticRule {
+  char operator()(const char cell) const {
+    return (R::NEXT >> static_cast<unsigned char>(cell)) & 1;
+  }
+  // Whether a dead cell with no neighbours stays dead, letting the
+  // kernels skip runs of empty cells.
+  constexpr bool zeroStaysDead() const { return (R::NEXT & 1) == 0; }
+};
+
+struct DynamicRule {
+  std::uint32_t next;
+  char operator()(const char cell) const {
+    return (next >> static_cast<unsigned char>(cell)) & 1;
+  }
+  bool zeroStaysDead() const { return (next & 1) == 0; }
+};
+
+// Calls step with the kernel rule for rule, pre-instantiated for the
+// common rules.
+template <typename Step> void dispatchRule(const Rule &rule, Step &&step) {
+  if (rule == CONWAY) {
+    step(StaticRule<Conway>());
+  } else if (rule == HIGHLIFE) {
+    step(StaticRule<HighLife>());
+  } else if (rule == SEEDS) {
+    step(StaticRule<Seeds>());
+  } else if (rule == DAY_AND_NIGHT) {
+    step(StaticRule<DayAndNight>());
+  } else {
+    step(DynamicRule{packedRuleMask(rule.birth, rule.survive)});
+  }
+}
+
+// Unchecked form of setCellState(ALIVE) for cells at least one away from
+// every edge. Adding 2 is the same as incrementing the count in bits 1+.
+inline void markAliveInterior(char *cell, const int width) {
+  char *above = cell - width;
+  char *below = cell + width;
+  above[-1] += 2;
+  above[0] += 2;
+  above[1] += 2;
+  cell[-1] += 2;
+  cell[0] |= ALIVE;
+  cell[1] += 2;
+  below[-1] += 2;
+  below[0] += 2;
+  below[1] += 2;
+}
+
+// SplitMix64's output function over seed and a counter, so any word of the
+// stream can be made without the ones before it.
+inline std::uint64_t mixBits(const std::uint64_t seed,
+                             const std::uint64_t counter) {
+  std::uint64_t z = seed + counter * 0x9E3779B97F4A7C15ull;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+// The Zobrist key of the cell at index, made on demand rather than kept in
+// a table the size of the board.
+inline std::uint64_t cellKey(const std::size_t index) {
+  return mixBits(0x5A0B2C1D3E4F5061ull, index);
+}
+
+// Moves (x, y), at most one cell past an edge, to the board cell it stands
+// for under boundary. Returns false for a cell past a dead edge.
+inline bool wrapCell(const Boundary boundary, const int height,
+                     const int width, int &x, int &y) {
+  if (x >= 0 && y >= 0 && x < width && y < height) {
+    return true;
+  }
+  if (boundary == Boundary::DEAD) {
+    return false;
+  }
+  if (y < 0 || y >= height) {
+    y = y < 0 ? y + height : y - height;
+    if (boundary == Boundary::KLEIN) {
+      x = width - 1 - x;
+    }
+  }
+  if (x < 0) {
+    x += width;
+  } else if (x >= width) {
+    x -= width;
+  }
+  return true;
+}
+
+// (neighbour count << 1) | alive of one cell from bit 0 of alive, looking
+// across the boundary. For the edge cells; the kernels count the rest
+// directly. On a wrapped board narrower or shorter than three, a cell
+// can be its own neighbour, or the same neighbour twice, and counts so.
+char countCell(const char *alive, const int height, const int width,
+               const Boundary boundary, const int x, const int y) {
+  int count = 0;
+  for (int j = -1; j <= 1; j++) {
+    for (int i = -1; i <= 1; i++) {
+      int nx = x + i;
+      int ny = y + j;
+      if ((i != 0 || j != 0) && wrapCell(boundary, height, width, nx, ny)) {
+        count += alive[ny * width + nx] & 1;
+      }
+    }
+  }
+  return static_cast<char>((count << 1) | (alive[y * width + x] & 1));
+}
+
+// Rewrites rows [y0, y1) of out with (neighbour count << 1) | alive, where
+// the alive bits are taken from bit 0 of alive. The two may be the same
+// board since bit 0 is never changed.
+void recountRows(const char *alive, char *out, const int height,
+                 const int width, const Boundary boundary, const int y0,
+                 const int y1) {
+  for (int y = y0; y < y1; y++) {
+    const char *mid = alive + y * width;
+    char *row = out + y * width;
+    if (y == 0 || y == height - 1 || width < 3) {
+      for (int x = 0; x < width; x++) {
+        row[x] = countCell(alive, height, width, boundary, x, y);
+      }
+      continue;
+    }
+    const char *up = mid - width;
+    const char *down = mid + width;
+    row[0] = countCell(alive, height, width, boundary, 0, y);
+    for (int x = 1; x < width - 1; x++) {
+      const int count = (up[x - 1] & 1) + (up[x] & 1) + (up[x + 1] & 1) +
+                        (mid[x - 1] & 1) + (mid[x + 1] & 1) +
+                        (down[x - 1] & 1) + (down[x] & 1) + (down[x + 1] & 1);
+      row[x] = static_cast<char>((count << 1) | (mid[x] & 1));
+    }
+    row[width - 1] = countCell(alive, height, width, boundary, width - 1, y);
+  }
+}
+
+// Moves the neighbours' counts of a cell that flipped, across the boundary
+// at the board edges.
+void addToNeighbours(GameBoard &gameBoard, const int x, const int y,
+                     const char delta) {
+  char *board = gameBoard.board.data();
+  const int width = gameBoard.width;
+  const int height = gameBoard.height;
+  if (x > 0 && y > 0 && x < width - 1 && y < height - 1) {
+    char *cell = board + y * width + x;
+    char *above = cell - width;
+    char *below = cell + width;
+    above[-1] += delta;
+    above[0] += delta;
+    above[1] += delta;
+    cell[-1] += delta;
+    cell[1] += delta;
+    below[-1] += delta;
+    below[0] += delta;
+    below[1] += delta;
+    return;
+  }
+  for (int j = -1; j <= 1; j++) {
+    for (int i = -1; i <= 1; i++) {
+      int nx = x + i;
+      int ny = y + j;
+      if ((i != 0 || j != 0) &&
+          wrapCell(gameBoard.boundary, height, width, nx, ny)) {
+        board[ny * width + nx] += delta;
+      }
+    }
+  }
+}
+
+void flipCell(GameBoard &gameBoard, const int x, const int y) {
+  char *board = gameBoard.board.data();
+  const int width = gameBoard.width;
+  const char delta = (board[y * width + x] & ALIVE) ? -2 : 2;
+  board[y * width + x] ^= ALIVE;
+  if (gameBoard.hashing) {
+    gameBoard.hash ^= cellKey(y * width + x);
+  }
+  addToNeighbours(gameBoard, x, y, delta);
+}
+
+inline void markTileDirty(GameBoard &gameBoard, const int x, const int y) {
+  TileActivity &tiles = gameBoard.tiles;
+  if (!tiles.dirty.empty()) {
+    tiles.dirty[(y / LIFE_TILE_SIZE) * tiles.tilesX + x / LIFE_TILE_SIZE] = 1;
+  }
+}
+
+// After a full step every tile may have changed.
+inline void markAllTilesDirty(GameBoard &gameBoard) {
+  std::fill(gameBoard.tiles.dirty.begin(), gameBoard.tiles.dirty.end(), 1);
+}
+
+// Past this many listed changes per board cell the lists are dropped for
+// changes.full; patching that many cells costs as much as a full redraw.
+constexpr int FULL_CHANGE_DIVISOR = 4;
+
+inline void noteChange(GameBoard &gameBoard, const int x, const int y,
+                       const bool born) {
+  ChangeList &changes = gameBoard.changes;
+  if (!changes.enabled || changes.full) {
+    return;
+  }
+  if ((changes.births.size() + changes.deaths.size()) * FULL_CHANGE_DIVISOR >=
+      gameBoard.board.size()) {
+    changes.full = true;
+    changes.births.clear();
+    changes.deaths.clear();
+    return;
+  }
+  (born ? changes.births : changes.deaths).push_back(std::make_pair(x, y));
+}
+
+// Lists every cell whose alive bit differs between before and after,
+// eight cells at a time where none does.
+void noteStepChanges(GameBoard &gameBoard, const char *before,
+                     const char *after) {
+  if (!gameBoard.changes.enabled || gameBoard.changes.full) {
+    return;
+  }
+  constexpr std::uint64_t ALIVE_BITS = 0x0101010101010101ull;
+  const int width = gameBoard.width;
+  const std::size_t cells = gameBoard.board.size();
+  std::size_t i = 0;
+  while (i < cells) {
+    if (i + 8 <= cells) {
+      std::uint64_t a;
+      std::uint64_t b;
+      std::memcpy(&a, before + i, sizeof(a));
+      std::memcpy(&b, after + i, sizeof(b));
+      if (((a ^ b) & ALIVE_BITS) == 0) {
+        i += 8;
+        continue;
+      }
+    }
+    if ((before[i] ^ after[i]) & ALIVE) {
+      noteChange(gameBoard, static_cast<int>(i % width),
+                 static_cast<int>(i / width), after[i] & ALIVE);
+    }
+    i++;
+  }
+}
+
+// The XOR of the keys of cells [begin, end) whose alive bit differs
+// between before and after, eight cells at a time where none does.
+std::uint64_t flipKeys(const char *before, const char *after, int begin,
+                       const int end) {
+  constexpr std::uint64_t ALIVE_BITS = 0x0101010101010101ull;
+  std::uint64_t keys = 0;
+  for (; begin + 8 <= end; begin += 8) {
+    std::uint64_t a;
+    std::uint64_t b;
+    std::memcpy(&a, before + begin, sizeof(a));
+    std::memcpy(&b, after + begin, sizeof(b));
+    for (std::uint64_t flips = (a ^ b) & ALIVE_BITS; flips != 0;
+         flips &= flips - 1) {
+      keys ^= cellKey(begin + __builtin_ctzll(flips) / 8);
+    }
+  }
+  for (; begin < end; begin++) {
+    if ((before[begin] ^ after[begin]) & ALIVE) {
+      keys ^= cellKey(begin);
+    }
+  }
+  return keys;
+}
+
+inline bool allDead8(const char *cells) {
+  std::uint64_t word;
+  std::memcpy(&word, cells, sizeof(word));
+  return word == 0;
+}
+} // namespace
+
+std::size_t AliveList::find(const int cell) const {
+  const std::size_t mask = table.size() - 1;
+  std::size_t i = home(cell);
+  while (table[i].position >= 0 && table[i].cell != cell) {
+    i = (i + 1) & mask;
+  }
+  return i;
+}
+
+void AliveList::reindex() {
+  std::size_t capacity = 16;
+  int bits = 4;
+  while (capacity < 2 * x.size()) {
+    capacity *= 2;
+    bits++;
+  }
+  table.assign(capacity, Slot{0, -1});
+  shift = 32 - bits;
+  for (std::size_t i = 0; i < x.size(); i++) {
+    const int cell = y[i] * width + x[i];
+    table[find(cell)] = Slot{cell, static_cast<int>(i)};
+  }
+  indexed = true;
+}
+
+void AliveList::erase(const int cellX, const int cellY) {
+  if (!indexed) {
+    reindex();
+  }
+  const std::size_t mask = table.size() - 1;
+  std::size_t hole = find(cellY * width + cellX);
+  const int position = table[hole].position;
+  if (position < 0) {
+    return;
+  }
+  // Pull later entries of the probe run back over the hole, so lookups
+  // never need to step over removed slots.
+  for (std::size_t next = (hole + 1) & mask; table[next].position >= 0;
+       next = (next + 1) & mask) {
+    const std::size_t wanted = home(table[next].cell);
+    if (((next - wanted) & mask) >= ((next - hole) & mask)) {
+      table[hole] = table[next];
+      hole = next;
+    }
+  }
+  table[hole].position = -1;
+  const int last = static_cast<int>(x.size()) - 1;
+  if (position != last) {
+    table[find(y[last] * width + x[last])].position = position;
+    x[position] = x[last];
+    y[position] = y[last];
+  }
+  x.pop_back();
+  y.pop_back();
+}
+
+GameBoard genBoard(int height, int width, Boundary boundary) {
   GameBoard gameBoard;
+  gameBoard.boundary = boundary;
   gameBoard.board = Board(height * width, 0);
   gameBoard.height = height;
   gameBoard.width = width;
-  gameBoard.aliveList = AliveList();
+  gameBoard.aliveList = AliveList(width);
+  gameBoard.nextBoard = Board(height * width, 0);
+  TileActivity &tiles = gameBoard.tiles;
+  tiles.tilesX = (width + LIFE_TILE_SIZE - 1) / LIFE_TILE_SIZE;
+  tiles.tilesY = (height + LIFE_TILE_SIZE - 1) / LIFE_TILE_SIZE;
+  tiles.dirty = std::vector<char>(tiles.tilesX * tiles.tilesY, 1);
+  tiles.active = std::vector<char>(tiles.tilesX * tiles.tilesY, 0);
   return gameBoard;
 }
 
@@ -22,24 +368,348 @@ char getCellState(const GameBoard &gameBoard, const int x,
 
 void setCellState(GameBoard &gameBoard, const int x,
                   const int y, char state) {
-  const int start_x = std::max(0, x - 1);
-  const int start_y = std::max(0, y - 1);
-  const int end_x = std::min(gameBoard.width, x + 2);
-  const int end_y = std::min(gameBoard.height, y + 2);
-  int count = 0;
-  for (int i = start_x; i < end_x; i++) {
-    for (int j = start_y; j < end_y; j++) {
-      if (i == x && j == y) {
-        gameBoard.board[j * gameBoard.width + i] = gameBoard.board[j * gameBoard.width + i] | state;
-      } else {
-        gameBoard.board[j * gameBoard.width + i] =
-            (((gameBoard.board[j * gameBoard.width + i] >> 1) + state) << 1) |
-            (gameBoard.board[j * gameBoard.width + i] & 0x01);
+  if (getCellState(gameBoard, x, y) == state) {
+    return;
+  }
+  flipCell(gameBoard, x, y);
+  noteChange(gameBoard, x, y, state == life::ALIVE);
+  if (state == life::ALIVE) {
+    gameBoard.aliveList.push(x, y);
+  } else {
+    gameBoard.aliveList.erase(x, y);
+  }
+  markTileDirty(gameBoard, x, y);
+}
+
+namespace {
+// Batches smaller than this are written cell by cell, skipping the
+// bookkeeping of choosing a recount.
+constexpr std::size_t BATCH_MIN_WRITES = 32;
+// Batches flipping at least 1 / EDIT_FULL_DIVISOR of the board recount it
+// whole.
+constexpr std::size_t EDIT_FULL_DIVISOR = 8;
+// Moving counts costs eight read-modify-writes per flipped cell and
+// recounting about one per cell, so the flipped cells' bounding box is
+// recounted when it is at most this many cells per flip.
+constexpr std::size_t EDIT_RECOUNT_CELLS_PER_FLIP = 8;
+// Widest stretch of a row recountSpan takes.
+constexpr int RECOUNT_CHUNK = 64;
+
+// Recounts cells [x0, x1) of row y, at most RECOUNT_CHUNK of them, from
+// copies of the three rows around them, zero padded at the board edges,
+// so the counting loop reads and writes different memory and vectorises.
+void recountSpan(char *cells, const int height, const int width, const int y,
+                 const int x0, const int x1) {
+  // Column i of the copies is board column x0 - 1 + i.
+  char rows[3][RECOUNT_CHUNK + 2] = {};
+  const int lo = std::max(0, x0 - 1);
+  const int hi = std::min(width, x1 + 1);
+  for (int r = 0; r < 3; r++) {
+    const int row = y - 1 + r;
+    if (row >= 0 && row < height) {
+      std::memcpy(rows[r] + (lo - (x0 - 1)),
+                  cells + static_cast<std::size_t>(row) * width + lo, hi - lo);
+    }
+  }
+  const char *up = rows[0];
+  const char *mid = rows[1];
+  const char *down = rows[2];
+  char *out = cells + static_cast<std::size_t>(y) * width + x0;
+  for (int i = 0; i < x1 - x0; i++) {
+    const int count = (up[i] & 1) + (up[i + 1] & 1) + (up[i + 2] & 1) +
+                      (mid[i] & 1) + (mid[i + 2] & 1) + (down[i] & 1) +
+                      (down[i + 1] & 1) + (down[i + 2] & 1);
+    out[i] = static_cast<char>((count << 1) | (mid[i + 1] & 1));
+  }
+}
+
+struct Flip {
+  int x;
+  int y;
+  bool born;
+};
+} // namespace
+
+void setCellStates(GameBoard &gameBoard, const std::vector<CellWrite> &writes) {
+  const int height = gameBoard.height;
+  const int width = gameBoard.width;
+  const auto inside = [&](const CellWrite &write) {
+    return write.x >= 0 && write.y >= 0 && write.x < width &&
+           write.y < height;
+  };
+  if (writes.size() < BATCH_MIN_WRITES) {
+    for (const CellWrite &write : writes) {
+      if (inside(write)) {
+        setCellState(gameBoard, write.x, write.y, write.state);
       }
     }
+    return;
   }
-  if (state == life::ALIVE) {
-    gameBoard.aliveList.push_back(std::make_pair(x, y));
+
+  // Set the alive bits only, leaving the counts stale, and list the flips.
+  char *cells = gameBoard.board.data();
+  std::vector<Flip> flips;
+  int minX = width;
+  int minY = height;
+  int maxX = -1;
+  int maxY = -1;
+  for (const CellWrite &write : writes) {
+    if (!inside(write)) {
+      continue;
+    }
+    char &cell = cells[write.y * width + write.x];
+    const char alive = write.state == ALIVE ? ALIVE : DEAD;
+    if ((cell & ALIVE) == alive) {
+      continue;
+    }
+    cell = static_cast<char>((cell & ~ALIVE) | alive);
+    if (gameBoard.hashing) {
+      gameBoard.hash ^= cellKey(write.y * width + write.x);
+    }
+    noteChange(gameBoard, write.x, write.y, alive == ALIVE);
+    if (alive == ALIVE) {
+      gameBoard.aliveList.push(write.x, write.y);
+    } else {
+      gameBoard.aliveList.erase(write.x, write.y);
+    }
+    markTileDirty(gameBoard, write.x, write.y);
+    flips.push_back(Flip{write.x, write.y, alive == ALIVE});
+    minX = std::min(minX, write.x);
+    minY = std::min(minY, write.y);
+    maxX = std::max(maxX, write.x);
+    maxY = std::max(maxY, write.y);
+  }
+  if (flips.empty()) {
+    return;
+  }
+
+  // Recount the whole board for a sweeping edit, from a copy so
+  // recountRows takes its vectorised path.
+  if (flips.size() * EDIT_FULL_DIVISOR >= gameBoard.board.size()) {
+    gameBoard.nextBoard.resize(gameBoard.board.size());
+    std::memcpy(gameBoard.nextBoard.data(), cells, gameBoard.board.size());
+    recountRows(gameBoard.nextBoard.data(), cells, height, width,
+                gameBoard.boundary, 0, height);
+    return;
+  }
+  // Recount just the rows and columns around a clustered edit, such as a
+  // pasted pattern or a brush stroke. recountSpan pads with dead cells, so
+  // on a wrapped board the box must keep clear of the edge cells.
+  const bool clearOfEdges = gameBoard.boundary == Boundary::DEAD ||
+                            (minX > 1 && minY > 1 && maxX < width - 2 &&
+                             maxY < height - 2);
+  const int x0 = std::max(0, minX - 1);
+  const int x1 = std::min(width, maxX + 2);
+  const int y0 = std::max(0, minY - 1);
+  const int y1 = std::min(height, maxY + 2);
+  const std::size_t area = static_cast<std::size_t>(x1 - x0) * (y1 - y0);
+  if (clearOfEdges && area <= flips.size() * EDIT_RECOUNT_CELLS_PER_FLIP) {
+    for (int y = y0; y < y1; y++) {
+      for (int x = x0; x < x1; x += RECOUNT_CHUNK) {
+        recountSpan(cells, height, width, y, x, std::min(x1, x + RECOUNT_CHUNK));
+      }
+    }
+    return;
+  }
+  // Scattered edits move their neighbours' counts one flip at a time.
+  for (const Flip &flip : flips) {
+    addToNeighbours(gameBoard, flip.x, flip.y, flip.born ? 2 : -2);
+  }
+}
+
+namespace {
+// The board was replaced wholesale: every tile may change and the change
+// lists no longer cover what did.
+void markBoardReplaced(GameBoard &gameBoard) {
+  markAllTilesDirty(gameBoard);
+  ChangeList &changes = gameBoard.changes;
+  changes.full = true;
+  changes.births.clear();
+  changes.deaths.clear();
+}
+
+constexpr int SEED_PRECISION = 16;
+
+// 64 cells, each alive with probability threshold / 2^16. Folding one
+// random word per binary digit of threshold, lowest first, ORing where the
+// digit is 1 and ANDing where it is 0, gives each bit exactly that
+// probability; 50% takes a single word.
+std::uint64_t seedWord(const std::uint64_t seed, const std::uint64_t index,
+                       const std::uint32_t threshold) {
+  if (threshold == 0) {
+    return 0;
+  }
+  if (threshold >= (1u << SEED_PRECISION)) {
+    return ~std::uint64_t(0);
+  }
+  std::uint64_t word = 0;
+  for (int digit = __builtin_ctz(threshold); digit < SEED_PRECISION;
+       digit++) {
+    const std::uint64_t bits = mixBits(seed, index * SEED_PRECISION + digit);
+    word = ((threshold >> digit) & 1) ? (word | bits) : (word & bits);
+  }
+  return word;
+}
+
+std::uint32_t seedThreshold(const double density) {
+  return static_cast<std::uint32_t>(std::lround(
+      std::min(1.0, std::max(0.0, density)) * (1u << SEED_PRECISION)));
+}
+
+// Eight bits to eight bytes of 0 or 1, bit i to byte i (little-endian).
+inline std::uint64_t spreadBits(const std::uint64_t bits) {
+  return ((((bits * 0x0101010101010101ull) & 0x8040201008040201ull) +
+           0x7F7F7F7F7F7F7F7Full) >>
+          7) &
+         0x0101010101010101ull;
+}
+
+// Like stepParallel: bands write bare alive bits into the back buffer and
+// list their cells, then recount their own rows into the board. runBands
+// runs task(0) .. task(bands - 1), serially or on a pool.
+template <typename RunBands>
+void seedBands(GameBoard &gameBoard, const double density,
+               const std::uint64_t seed, const int bands,
+               const RunBands &runBands) {
+  const int height = gameBoard.height;
+  const int width = gameBoard.width;
+  const std::uint32_t threshold = seedThreshold(density);
+  if (static_cast<int>(gameBoard.bandAliveLists.size()) != bands) {
+    gameBoard.bandAliveLists.resize(bands);
+  }
+  gameBoard.nextBoard.resize(gameBoard.board.size());
+  const auto bandStart = [&](const int band) {
+    return static_cast<int>(static_cast<long long>(height) * band / bands);
+  };
+  const std::size_t words = (static_cast<std::size_t>(width) + 63) / 64;
+
+  char *alive = gameBoard.nextBoard.data();
+  runBands(bands, [&](const int band) {
+    CellList &bandAlive = gameBoard.bandAliveLists[band];
+    bandAlive.clear();
+    for (int y = bandStart(band); y < bandStart(band + 1); y++) {
+      char *row = alive + static_cast<std::size_t>(y) * width;
+      for (std::size_t i = 0; i < words; i++) {
+        const std::uint64_t bits = seedWord(seed, y * words + i, threshold);
+        const int first = static_cast<int>(i * 64);
+        const int last = std::min(width, first + 64);
+        int x = first;
+        for (; x + 8 <= last; x += 8) {
+          const std::uint64_t bytes = spreadBits((bits >> (x - first)) & 0xFF);
+          std::memcpy(row + x, &bytes, sizeof(bytes));
+        }
+        for (; x < last; x++) {
+          row[x] = static_cast<char>((bits >> (x - first)) & 1);
+        }
+        for (std::uint64_t rest = bits; rest != 0; rest &= rest - 1) {
+          const int x = first + __builtin_ctzll(rest);
+          if (x >= last) {
+            break;
+          }
+          bandAlive.push_back(std::make_pair(x, y));
+        }
+      }
+    }
+  });
+
+  AliveList &aliveList = gameBoard.aliveList;
+  aliveList.clear();
+  std::size_t total = 0;
+  for (const auto &bandAlive : gameBoard.bandAliveLists) {
+    total += bandAlive.size();
+  }
+  aliveList.x.resize(total);
+  aliveList.y.resize(total);
+
+  char *dst = gameBoard.board.data();
+  std::atomic<std::uint64_t> hash{0};
+  runBands(bands, [&](const int band) {
+    recountRows(alive, dst, height, width, gameBoard.boundary,
+                bandStart(band), bandStart(band + 1));
+    std::size_t offset = 0;
+    for (int i = 0; i < band; i++) {
+      offset += gameBoard.bandAliveLists[i].size();
+    }
+    std::uint64_t bandHash = 0;
+    for (const auto &cell : gameBoard.bandAliveLists[band]) {
+      aliveList.x[offset] = cell.first;
+      aliveList.y[offset] = cell.second;
+      if (gameBoard.hashing) {
+        bandHash ^= cellKey(cell.second * width + cell.first);
+      }
+      offset++;
+    }
+    hash.fetch_xor(bandHash, std::memory_order_relaxed);
+  });
+  gameBoard.hash = hash.load(std::memory_order_relaxed);
+  markBoardReplaced(gameBoard);
+}
+} // namespace
+
+void rebuildBoard(GameBoard &gameBoard) {
+  char *cells = gameBoard.board.data();
+  const int width = gameBoard.width;
+  recountRows(cells, cells, gameBoard.height, width, gameBoard.boundary, 0,
+              gameBoard.height);
+  AliveList &aliveList = gameBoard.aliveList;
+  aliveList.clear();
+  std::uint64_t hash = 0;
+  for (int y = 0; y < gameBoard.height; y++) {
+    const char *row = cells + static_cast<std::size_t>(y) * width;
+    for (int x = 0; x < width; x++) {
+      if (row[x] & ALIVE) {
+        aliveList.push(x, y);
+        if (gameBoard.hashing) {
+          hash ^= cellKey(y * width + x);
+        }
+      }
+    }
+  }
+  gameBoard.hash = hash;
+  markBoardReplaced(gameBoard);
+}
+
+std::uint64_t boardHash(const GameBoard &gameBoard) {
+  std::uint64_t hash = 0;
+  const char *cells = gameBoard.board.data();
+  const int size = static_cast<int>(gameBoard.board.size());
+  for (int i = 0; i < size; i++) {
+    if (cells[i] & ALIVE) {
+      hash ^= cellKey(i);
+    }
+  }
+  return hash;
+}
+
+void seedBoard(GameBoard &gameBoard, const double density,
+               const std::uint64_t seed) {
+  seedBands(gameBoard, density, seed, 1,
+            [](const int count, const auto &task) {
+              for (int i = 0; i < count; i++) {
+                task(i);
+              }
+            });
+}
+
+void seedBoard(GameBoard &gameBoard, const double density,
+               const std::uint64_t seed, ThreadPool &pool) {
+  const int bands = std::max(1, std::min(gameBoard.height, pool.size() * 4));
+  seedBands(gameBoard, density, seed, bands,
+            [&pool](const int count, const std::function<void(int)> &task) {
+              pool.run(count, task);
+            });
+}
+
+void seedRow(char *cells, const int width, const int y, const int x0,
+             const int x1, const double density, const std::uint64_t seed) {
+  const std::uint32_t threshold = seedThreshold(density);
+  const std::uint64_t words = (static_cast<std::uint64_t>(width) + 63) / 64;
+  std::uint64_t bits = 0;
+  for (int x = x0; x < x1; x++) {
+    if (x == x0 || x % 64 == 0) {
+      bits = seedWord(seed, y * words + x / 64, threshold);
+    }
+    cells[x - x0] = static_cast<char>((bits >> (x % 64)) & 1);
   }
 }
 
@@ -48,7 +718,9 @@ int neighborCount(const GameBoard &gameBoard,
   return gameBoard.board[y * gameBoard.width + x] >> 1;
 }
 
-void iterateBoard(GameBoard &gameBoard) {
+namespace {
+template <typename NextState>
+void stepSerial(GameBoard &gameBoard, const NextState nextAlive) {
   /*
       Any live cell with fewer than two live neighbours dies, as if by
      underpopulation. Any live cell with two or three live neighbours lives on
@@ -57,26 +729,358 @@ void iterateBoard(GameBoard &gameBoard) {
      neighbours becomes a live cell, as if by reproduction.
   */
 
-  GameBoard newGameBoard = genBoard(gameBoard.height, gameBoard.width);
-  for (int i = 0; i < gameBoard.height; i++) {
-    for (int j = 0; j < gameBoard.width; j++) {
-      int count = neighborCount(gameBoard,j, i);
-      int cellState = getCellState(gameBoard, j, i);
-      if (cellState == life::ALIVE) {
-        if (count < 2 || count > 3) {
-          setCellState(newGameBoard, j, i, life::DEAD);
-        } else {
-          setCellState(newGameBoard, j, i, life::ALIVE);
-        }
-      } else {
-        if (count == 3) {
-          setCellState(newGameBoard, j, i, life::ALIVE);
+  // Step into the back buffer and swap. The buffers keep their capacity so
+  // no allocation happens once the board has reached its steady state.
+  GameBoard newGameBoard;
+  newGameBoard.height = gameBoard.height;
+  newGameBoard.width = gameBoard.width;
+  newGameBoard.boundary = gameBoard.boundary;
+  newGameBoard.board = std::move(gameBoard.nextBoard);
+  newGameBoard.board.assign(gameBoard.board.size(), 0);
+  newGameBoard.aliveList = std::move(gameBoard.aliveList);
+  newGameBoard.aliveList.clear();
+  const int height = gameBoard.height;
+  const int width = gameBoard.width;
+  const char *src = gameBoard.board.data();
+  char *dst = newGameBoard.board.data();
+  // A row's alive bits are final once it is done, as later rows only add to
+  // its counts, so its flips are hashed while it is still in cache.
+  // newGameBoard does not hash.
+  std::uint64_t hash = gameBoard.hash;
+  for (int y = 0; y < height; y++) {
+    const char *srcRow = src + y * width;
+    if (y == 0 || y == height - 1 || width < 3) {
+      // Border rows take the path that looks across the boundary.
+      for (int x = 0; x < width; x++) {
+        if (nextAlive(srcRow[x])) {
+          setCellState(newGameBoard, x, y, life::ALIVE);
         }
       }
+      if (gameBoard.hashing) {
+        hash ^= flipKeys(src, dst, y * width, (y + 1) * width);
+      }
+      continue;
+    }
+    char *dstRow = dst + y * width;
+    if (nextAlive(srcRow[0])) {
+      setCellState(newGameBoard, 0, y, life::ALIVE);
+    }
+    int x = 1;
+    while (x < width - 1) {
+      // A zero cell is dead with no neighbours and, unless the rule has B0,
+      // stays dead, so skip runs of them a word at a time.
+      if (nextAlive.zeroStaysDead() && x + 8 <= width - 1 &&
+          allDead8(srcRow + x)) {
+        x += 8;
+        continue;
+      }
+      if (nextAlive(srcRow[x])) {
+        markAliveInterior(dstRow + x, width);
+        newGameBoard.aliveList.push(x, y);
+      }
+      x++;
+    }
+    if (nextAlive(srcRow[width - 1])) {
+      setCellState(newGameBoard, width - 1, y, life::ALIVE);
+    }
+    if (gameBoard.hashing) {
+      hash ^= flipKeys(src, dst, y * width, (y + 1) * width);
     }
   }
+  gameBoard.nextBoard = std::move(gameBoard.board);
   gameBoard.board = std::move(newGameBoard.board);
   gameBoard.aliveList = std::move(newGameBoard.aliveList);
+  gameBoard.hash = hash;
+  noteStepChanges(gameBoard, gameBoard.nextBoard.data(),
+                  gameBoard.board.data());
+  markAllTilesDirty(gameBoard);
+}
+
+template <typename NextState>
+void stepParallel(GameBoard &gameBoard, ThreadPool &pool, const int bands,
+                  const NextState nextAlive) {
+  const int height = gameBoard.height;
+  const int width = gameBoard.width;
+  if (static_cast<int>(gameBoard.bandAliveLists.size()) != bands) {
+    gameBoard.bandAliveLists.resize(bands);
+  }
+  gameBoard.nextBoard.resize(gameBoard.board.size());
+  const auto bandStart = [&](const int band) {
+    return static_cast<int>(static_cast<long long>(height) * band / bands);
+  };
+
+  // Phase one: every band reads only the current board and writes only
+  // its own rows of the back buffer, which holds bare alive bits.
+  const char *src = gameBoard.board.data();
+  char *alive = gameBoard.nextBoard.data();
+  std::atomic<std::uint64_t> hash{gameBoard.hash};
+  pool.run(bands, [&](const int band) {
+    CellList &bandAlive = gameBoard.bandAliveLists[band];
+    bandAlive.clear();
+    std::uint64_t flips = 0;
+    for (int y = bandStart(band); y < bandStart(band + 1); y++) {
+      for (int x = 0; x < width; x++) {
+        const char next = nextAlive(src[y * width + x]);
+        alive[y * width + x] = next;
+        if (next) {
+          bandAlive.push_back(std::make_pair(x, y));
+        }
+      }
+      if (gameBoard.hashing) {
+        flips ^= flipKeys(src, alive, y * width, (y + 1) * width);
+      }
+    }
+    hash.fetch_xor(flips, std::memory_order_relaxed);
+  });
+  gameBoard.hash = hash.load(std::memory_order_relaxed);
+  noteStepChanges(gameBoard, src, alive);
+
+  AliveList &aliveList = gameBoard.aliveList;
+  aliveList.clear();
+  std::size_t total = 0;
+  for (const auto &bandAlive : gameBoard.bandAliveLists) {
+    total += bandAlive.size();
+  }
+  aliveList.x.resize(total);
+  aliveList.y.resize(total);
+
+  // Phase two: the current board is no longer read, so each band rebuilds
+  // its rows in place from the alive bits, reading across band edges but
+  // writing only its own rows.
+  char *dst = gameBoard.board.data();
+  pool.run(bands, [&](const int band) {
+    recountRows(alive, dst, height, width, gameBoard.boundary,
+                bandStart(band), bandStart(band + 1));
+    std::size_t offset = 0;
+    for (int i = 0; i < band; i++) {
+      offset += gameBoard.bandAliveLists[i].size();
+    }
+    for (const auto &cell : gameBoard.bandAliveLists[band]) {
+      aliveList.x[offset] = cell.first;
+      aliveList.y[offset] = cell.second;
+      offset++;
+    }
+  });
+  markAllTilesDirty(gameBoard);
+}
+
+// A tile on the edge of a wrapped board also borders the tiles across the
+// boundary: activates those holding the ring of cells around tile (tx, ty)
+// that lie past an edge.
+void activateAcrossEdges(GameBoard &gameBoard, const int tx, const int ty) {
+  TileActivity &tiles = gameBoard.tiles;
+  const int height = gameBoard.height;
+  const int width = gameBoard.width;
+  const int x0 = tx * LIFE_TILE_SIZE - 1;
+  const int y0 = ty * LIFE_TILE_SIZE - 1;
+  const int x1 = std::min(width, (tx + 1) * LIFE_TILE_SIZE);
+  const int y1 = std::min(height, (ty + 1) * LIFE_TILE_SIZE);
+  const auto activate = [&](int x, int y) {
+    if ((x < 0 || y < 0 || x >= width || y >= height) &&
+        wrapCell(gameBoard.boundary, height, width, x, y)) {
+      tiles.active[(y / LIFE_TILE_SIZE) * tiles.tilesX + x / LIFE_TILE_SIZE] =
+          1;
+    }
+  };
+  for (int x = x0; x <= x1; x++) {
+    activate(x, y0);
+    activate(x, y1);
+  }
+  for (int y = y0 + 1; y < y1; y++) {
+    activate(x0, y);
+    activate(x1, y);
+  }
+}
+
+template <typename NextState>
+void stepSparse(GameBoard &gameBoard, const NextState nextAlive) {
+  TileActivity &tiles = gameBoard.tiles;
+  const int width = gameBoard.width;
+  const int height = gameBoard.height;
+
+  // Only a tile that changed, or borders one that did, can change now.
+  std::fill(tiles.active.begin(), tiles.active.end(), 0);
+  for (int ty = 0; ty < tiles.tilesY; ty++) {
+    for (int tx = 0; tx < tiles.tilesX; tx++) {
+      if (!tiles.dirty[ty * tiles.tilesX + tx]) {
+        continue;
+      }
+      for (int j = std::max(0, ty - 1); j < std::min(tiles.tilesY, ty + 2); j++) {
+        for (int i = std::max(0, tx - 1); i < std::min(tiles.tilesX, tx + 2); i++) {
+          tiles.active[j * tiles.tilesX + i] = 1;
+        }
+      }
+      if (gameBoard.boundary != Boundary::DEAD &&
+          (tx == 0 || ty == 0 || tx == tiles.tilesX - 1 ||
+           ty == tiles.tilesY - 1)) {
+        activateAcrossEdges(gameBoard, tx, ty);
+      }
+    }
+  }
+  std::fill(tiles.dirty.begin(), tiles.dirty.end(), 0);
+
+  // Evaluate every active tile against the unchanged board first, then
+  // apply the flips, so the neighbour counts stay consistent throughout.
+  const char *board = gameBoard.board.data();
+  tiles.changed.clear();
+  tiles.activeCount = 0;
+  for (int ty = 0; ty < tiles.tilesY; ty++) {
+    for (int tx = 0; tx < tiles.tilesX; tx++) {
+      const int tile = ty * tiles.tilesX + tx;
+      if (!tiles.active[tile]) {
+        continue;
+      }
+      tiles.activeCount++;
+      const int endY = std::min(height, (ty + 1) * LIFE_TILE_SIZE);
+      const int endX = std::min(width, (tx + 1) * LIFE_TILE_SIZE);
+      for (int y = ty * LIFE_TILE_SIZE; y < endY; y++) {
+        for (int x = tx * LIFE_TILE_SIZE; x < endX; x++) {
+          const char cell = board[y * width + x];
+          const char next = nextAlive(cell);
+          if (next != (cell & ALIVE)) {
+            tiles.changed.push_back(y * width + x);
+          }
+        }
+      }
+    }
+  }
+  // setCellState keeps the neighbour counts, the alive list and the dirty
+  // tiles in step with each flip.
+  for (const int index : tiles.changed) {
+    const int x = index % width;
+    const int y = index / width;
+    setCellState(gameBoard, x, y,
+                 getCellState(gameBoard, x, y) == ALIVE ? DEAD : ALIVE);
+  }
+}
+} // namespace
+
+void iterateBoard(GameBoard &gameBoard) {
+  dispatchRule(gameBoard.rule,
+               [&](const auto rule) { stepSerial(gameBoard, rule); });
+}
+
+void iterateBoard(GameBoard &gameBoard, ThreadPool &pool) {
+  // A few bands per thread so an uneven band does not stall the step.
+  const int bands = std::min(gameBoard.height, pool.size() * 4);
+  if (bands <= 1) {
+    iterateBoard(gameBoard);
+    return;
+  }
+  dispatchRule(gameBoard.rule, [&](const auto rule) {
+    stepParallel(gameBoard, pool, bands, rule);
+  });
+}
+
+void iterateBoardSparse(GameBoard &gameBoard) {
+  dispatchRule(gameBoard.rule,
+               [&](const auto rule) { stepSparse(gameBoard, rule); });
+}
+
+void setRule(GameBoard &gameBoard, const Rule &rule) {
+  gameBoard.rule = rule;
+  // Cells that were stable under the old rule may not be under the new.
+  markAllTilesDirty(gameBoard);
+}
+
+void setBoundary(GameBoard &gameBoard, const Boundary boundary) {
+  gameBoard.boundary = boundary;
+  char *cells = gameBoard.board.data();
+  const int height = gameBoard.height;
+  const int width = gameBoard.width;
+  if (height == 0 || width == 0) {
+    return;
+  }
+  // Only the edge cells have neighbours across the boundary.
+  recountRows(cells, cells, height, width, boundary, 0, 1);
+  recountRows(cells, cells, height, width, boundary, height - 1, height);
+  for (int y = 1; y < height - 1; y++) {
+    cells[y * width] = countCell(cells, height, width, boundary, 0, y);
+    cells[y * width + width - 1] =
+        countCell(cells, height, width, boundary, width - 1, y);
+  }
+  markAllTilesDirty(gameBoard);
+}
+
+void trackChanges(GameBoard &gameBoard, const bool enabled) {
+  ChangeList &changes = gameBoard.changes;
+  if (enabled && !changes.enabled) {
+    changes.full = true;
+  }
+  changes.enabled = enabled;
+  if (!enabled) {
+    changes.births.clear();
+    changes.deaths.clear();
+  }
+}
+
+void trackHash(GameBoard &gameBoard, const bool enabled) {
+  if (enabled && !gameBoard.hashing) {
+    gameBoard.hash = boardHash(gameBoard);
+  }
+  gameBoard.hashing = enabled;
+}
+
+void clearChanges(GameBoard &gameBoard) {
+  ChangeList &changes = gameBoard.changes;
+  changes.births.clear();
+  changes.deaths.clear();
+  changes.full = false;
+}
+
+std::optional<Rule> parseRule(const std::string_view text) {
+  Rule rule{0, 0};
+  bool seenBirth = false;
+  bool seenSurvive = false;
+  std::uint16_t *part = nullptr;
+  for (std::size_t i = 0; i < text.size(); i++) {
+    const char c = text[i];
+    if (c == 'B' || c == 'b' || c == 'S' || c == 's') {
+      bool &seen = (c == 'B' || c == 'b') ? seenBirth : seenSurvive;
+      if (seen) {
+        return std::nullopt;
+      }
+      seen = true;
+      part = (c == 'B' || c == 'b') ? &rule.birth : &rule.survive;
+    } else if (c >= '0' && c <= '8' && part != nullptr) {
+      *part |= static_cast<std::uint16_t>(1u << (c - '0'));
+    } else if (!(c == '/' && part != nullptr && i + 1 < text.size())) {
+      return std::nullopt;
+    }
+  }
+  if (!seenBirth || !seenSurvive) {
+    return std::nullopt;
+  }
+  return rule;
+}
+
+std::string ruleString(const Rule &rule) {
+  std::string text = "B";
+  for (int count = 0; count <= 8; count++) {
+    if (rule.birth & (1u << count)) {
+      text += static_cast<char>('0' + count);
+    }
+  }
+  text += "/S";
+  for (int count = 0; count <= 8; count++) {
+    if (rule.survive & (1u << count)) {
+      text += static_cast<char>('0' + count);
+    }
+  }
+  return text;
+}
+
+std::optional<Boundary> parseBoundary(const std::string_view text) {
+  if (text == "dead") {
+    return Boundary::DEAD;
+  }
+  if (text == "torus") {
+    return Boundary::TORUS;
+  }
+  if (text == "klein") {
+    return Boundary::KLEIN;
+  }
+  return std::nullopt;
 }
 
 void printBoard(GameBoard gameBoard) {
@@ -1,28 +1,282 @@
 // life.hpp
+#ifndef LIFE_H
+#define LIFE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 namespace life {
 constexpr int LIFE_BOARD_WIDTH = 100;
 constexpr int LIFE_BOARD_HEIGHT = 100;
 
+// Side of the square tiles iterateBoardSparse tracks activity in.
+constexpr int LIFE_TILE_SIZE = 32;
+
 constexpr char DEAD = 0;
 constexpr char ALIVE = 1;
 
+// The next state of a cell as a bit mask over its packed value
+// (neighbour count << 1) | alive, given birth and survival masks with bit n
+// set for n neighbours.
+constexpr std::uint32_t packedRuleMask(std::uint16_t birth,
+                                       std::uint16_t survive) {
+    std::uint32_t mask = 0;
+    for (int count = 0; count <= 8; count++) {
+        if (birth & (1u << count)) {
+            mask |= 1u << (count << 1);
+        }
+        if (survive & (1u << count)) {
+            mask |= 1u << ((count << 1) | 1);
+        }
+    }
+    return mask;
+}
+
+// A life-like rule fixed at compile time. The stepping kernels are
+// instantiated per rule, so the rule costs a shift and a mask per cell.
+template <std::uint16_t Birth, std::uint16_t Survive>
+struct LifeRule {
+    static constexpr std::uint16_t BIRTH = Birth;
+    static constexpr std::uint16_t SURVIVE = Survive;
+    static constexpr std::uint32_t NEXT = packedRuleMask(Birth, Survive);
+};
+
+using Conway = LifeRule<(1 << 3), (1 << 2) | (1 << 3)>;
+using HighLife = LifeRule<(1 << 3) | (1 << 6), (1 << 2) | (1 << 3)>;
+using Seeds = LifeRule<(1 << 2), 0>;
+using DayAndNight = LifeRule<(1 << 3) | (1 << 6) | (1 << 7) | (1 << 8),
+                             (1 << 3) | (1 << 4) | (1 << 6) | (1 << 7) |
+                                 (1 << 8)>;
+
+// A life-like rule chosen at run time. Boards carry one; iterateBoard
+// dispatches the rules above to their own kernels and runs any other rule
+// through a kernel that reads the mask at run time.
+struct Rule {
+    std::uint16_t birth;
+    std::uint16_t survive;
+
+    template <typename R> static constexpr Rule of() {
+        return Rule{R::BIRTH, R::SURVIVE};
+    }
+    bool operator==(const Rule &other) const {
+        return birth == other.birth && survive == other.survive;
+    }
+    bool operator!=(const Rule &other) const { return !(*this == other); }
+};
+
+constexpr Rule CONWAY = Rule::of<Conway>();
+constexpr Rule HIGHLIFE = Rule::of<HighLife>();
+constexpr Rule SEEDS = Rule::of<Seeds>();
+constexpr Rule DAY_AND_NIGHT = Rule::of<DayAndNight>();
+
+// Parses a rulestring such as "B3/S23" or "b36/s23"; the slash and the
+// order of the parts are optional. Returns nothing if it is malformed.
+std::optional<Rule> parseRule(std::string_view text);
+// Formats a rule as "B3/S23".
+std::string ruleString(const Rule &rule);
+
+// What lies past the board's edges. The kernels count the interior as
+// before and find an edge cell's neighbours across the boundary, so the
+// mode costs only the edge cells.
+enum class Boundary : std::uint8_t {
+    // Dead cells: the board is a walled box.
+    DEAD = 0,
+    // Wraps left to right and top to bottom.
+    TORUS = 1,
+    // Wraps like a torus, but crossing the top or bottom edge also mirrors
+    // the column, x becoming width - 1 - x.
+    KLEIN = 2,
+};
+
+// Parses "dead", "torus" or "klein". Returns nothing for anything else.
+std::optional<Boundary> parseBoundary(std::string_view text);
+
 using Board = std::vector<char>;
-using AliveList = std::vector<std::pair<int, int>>;
+using CellList = std::vector<std::pair<int, int>>;
+
+// One write of a batch for setCellStates.
+struct CellWrite {
+    int x;
+    int y;
+    char state;
+};
+
+// Live cells of a board as parallel x and y arrays, so renderers and
+// analytics can walk them without re-scanning the board. Whether a cell is
+// listed is its alive bit. Removing a cell finds its entry through a hash
+// table sized to the list, not the board, and moves the last entry into its
+// place. The stepping kernels refill the list with push() and leave the
+// table to be rebuilt by the next removal, so generations without edits
+// never touch it.
+struct AliveList {
+    std::vector<int> x;
+    std::vector<int> y;
+
+    AliveList() = default;
+    explicit AliveList(int width) : width(width) {}
+
+    std::size_t size() const { return x.size(); }
+    bool empty() const { return x.empty(); }
+    // Adds a cell the caller knows is not listed yet.
+    void push(int cellX, int cellY) {
+        x.push_back(cellX);
+        y.push_back(cellY);
+        if (indexed) {
+            if (2 * x.size() > table.size()) {
+                indexed = false;
+            } else {
+                const int cell = cellY * width + cellX;
+                table[find(cell)] = Slot{cell, static_cast<int>(x.size()) - 1};
+            }
+        }
+    }
+    // Removes a cell, if listed, by moving the last entry into its place.
+    void erase(int cellX, int cellY);
+    // Empties the list, keeping its capacity for the next generation.
+    void clear() {
+        x.clear();
+        y.clear();
+        indexed = false;
+    }
+    bool operator==(const AliveList &other) const {
+        return x == other.x && y == other.y;
+    }
+
+private:
+    // A cell's position in x and y, -1 for a free slot, keyed by its index
+    // on the board.
+    struct Slot {
+        int cell;
+        int position;
+    };
+    int width = 0;
+    // Open-addressed by a hash of the cell index; a power of two at least
+    // twice the list's size while indexed.
+    std::vector<Slot> table;
+    int shift = 32;
+    bool indexed = false;
+
+    std::size_t home(int cell) const {
+        return (static_cast<std::uint32_t>(cell) * 0x9E3779B9u) >> shift;
+    }
+    // The slot holding the cell, or the free slot that ends its probe.
+    std::size_t find(int cell) const;
+    void reindex();
+};
+
+// Per-tile bookkeeping for iterateBoardSparse.
+struct TileActivity {
+    int tilesX = 0;
+    int tilesY = 0;
+    // Tiles with a cell that changed since the last sparse step.
+    std::vector<char> dirty;
+    // Scratch: dirty tiles and their neighbours, evaluated this step.
+    std::vector<char> active;
+    // Scratch: indices of the cells that flip this step.
+    std::vector<int> changed;
+    // Number of tiles evaluated by the last sparse step.
+    int activeCount = 0;
+};
+
+// Cells that flipped since the consumer last called clearChanges, so a
+// renderer can patch what changed instead of redrawing the board. Off
+// unless enabled, as the full-board steps pay a diff pass to fill it. A
+// cell that flipped more than once appears in both lists, so consumers
+// should read its current state rather than replay the lists in order.
+struct ChangeList {
+    bool enabled = false;
+    // Set when the lists do not cover every change: tracking was just
+    // enabled, the board was replaced, or the lists grew past the point
+    // where redrawing everything is cheaper.
+    bool full = true;
+    CellList births;
+    CellList deaths;
+};
 
 struct GameBoard {
     Board board;
     int height;
     int width;
     AliveList aliveList;
+    // Back buffer for iterateBoard, swapped with board every generation so
+    // steady-state stepping never touches the allocator.
+    Board nextBoard;
+    // Per-band alive cells for the parallel iterateBoard, merged in band
+    // order so the result matches the serial step.
+    std::vector<CellList> bandAliveLists;
+    TileActivity tiles;
+    Rule rule = CONWAY;
+    Boundary boundary = Boundary::DEAD;
+    ChangeList changes;
+    // Zobrist hash of the live cells: the XOR of a fixed pseudo-random key
+    // per live cell index. While hashing is on, every write and step keeps
+    // it current by XORing in the keys of the cells that flip, so a board
+    // that returns to an earlier state returns to its hash. Off unless
+    // enabled, as the full-board steps pay a diff of every row for it.
+    bool hashing = false;
+    std::uint64_t hash = 0;
 };
 
-GameBoard genBoard(int height=LIFE_BOARD_HEIGHT, int width=LIFE_BOARD_WIDTH);
+class ThreadPool;
+
+GameBoard genBoard(int height=LIFE_BOARD_HEIGHT, int width=LIFE_BOARD_WIDTH,
+                   Boundary boundary=Boundary::DEAD);
 int neighborCount(const GameBoard &, int x, int y);
+// Changes the rule the board is stepped with.
+void setRule(GameBoard &board, const Rule &rule);
+// Changes what lies past the board's edges and recounts the edge cells'
+// neighbours to match.
+void setBoundary(GameBoard &board, Boundary boundary);
+// Turns change tracking on or off. Turning it on sets changes.full.
+void trackChanges(GameBoard &board, bool enabled);
+// Empties the change lists and clears changes.full once they are consumed.
+void clearChanges(GameBoard &board);
+// Turns hashing on or off. Turning it on computes the hash from the cells.
+void trackHash(GameBoard &board, bool enabled);
 char getCellState(const GameBoard &board, int x, int y);
+// Writing a cell's current state is a no-op, so repeated writes neither
+// double count neighbours nor duplicate alive list entries.
 void setCellState(GameBoard &board, int x, int y,
                   char state);
+// Applies a batch of writes as setCellState would, in order, skipping any
+// outside the board. Past a handful of writes it sets only the alive bits,
+// then recounts the rows around the edited ones in one vectorised pass
+// instead of moving eight neighbour counts per write.
+void setCellStates(GameBoard &board, const std::vector<CellWrite> &writes);
+// GameBoard::hash recomputed from the cells.
+std::uint64_t boardHash(const GameBoard &board);
+// Rebuilds the neighbour counts, the alive list, the hash and the tile and
+// change bookkeeping from bit 0 of every cell, for callers that fill board.board
+// with bare alive bits in bulk rather than through setCellState.
+void rebuildBoard(GameBoard &board);
+// Replaces every cell with a random one, alive with probability density
+// (to 1/65536). Cells come 64 at a time from a counter-based generator keyed
+// on seed and the cells' position, so a seed gives the same board on every
+// platform and thread count; the counts and alive list are built in one
+// pass after.
+void seedBoard(GameBoard &board, double density, std::uint64_t seed);
+void seedBoard(GameBoard &board, double density, std::uint64_t seed,
+               ThreadPool &pool);
+// The alive bits seedBoard(board, density, seed) gives cells [x0, x1) of
+// row y of a board width cells wide, one per char of cells, for callers that
+// hold only part of the board.
+void seedRow(char *cells, int width, int y, int x0, int x1, double density,
+             std::uint64_t seed);
 void iterateBoard(GameBoard &board);
+// Steps the board in horizontal bands on the pool. The result, including
+// the alive list order, is identical to iterateBoard(board).
+void iterateBoard(GameBoard &board, ThreadPool &pool);
+// Re-evaluates only the tiles that changed last generation and their
+// neighbours, so the cost follows activity rather than board area. The board
+// matches iterateBoard(board); the alive list holds the same cells, updated
+// in place from the cells that changed, so its order differs.
+void iterateBoardSparse(GameBoard &board);
 void printBoard(GameBoard board);
 } // namespace life
+
+#endif // LIFE_H
@@ -0,0 +1,88 @@
+// life_batch.cpp
+//
+// Runs a job list of independent boards without a window, one board per
+// task on every core, and writes a CSV summary per run as it finishes, e.g.
+//
+//   life_batch jobs.txt --threads 8 --out results.csv
+//
+// with jobs.txt holding lines such as
+//
+//   size=256 density=0.1,0.3,0.5 rule=B3/S23,B36/S23 seed=1,2,3
+//
+// See parseJobs in batch.hpp for the keys. The job list is read from
+// standard input when its path is "-".
+#include "WorkStealingPool.hpp"
+#include "batch.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+
+int main(int argc, char *argv[]) {
+  const char *jobsPath = nullptr;
+  const char *outPath = nullptr;
+  int threads = 0;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+      threads = std::atoi(argv[++i]);
+    } else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+      outPath = argv[++i];
+    } else if (jobsPath == nullptr) {
+      jobsPath = argv[i];
+    } else {
+      jobsPath = nullptr;
+      break;
+    }
+  }
+  if (jobsPath == nullptr) {
+    std::cerr << "usage: life_batch JOBS|- [--threads N] [--out PATH]"
+              << std::endl;
+    return 2;
+  }
+
+  std::ifstream jobsFile;
+  if (std::strcmp(jobsPath, "-") != 0) {
+    jobsFile.open(jobsPath);
+    if (!jobsFile) {
+      std::cerr << "Could not open job list: " << jobsPath << std::endl;
+      return 1;
+    }
+  }
+  int errorLine = 0;
+  const auto jobs =
+      life::parseJobs(jobsFile.is_open() ? jobsFile : std::cin, &errorLine);
+  if (!jobs) {
+    std::cerr << "Could not parse job list line " << errorLine << std::endl;
+    return 1;
+  }
+
+  std::ofstream outFile;
+  if (outPath != nullptr) {
+    outFile.open(outPath);
+    if (!outFile) {
+      std::cerr << "Could not open output: " << outPath << std::endl;
+      return 1;
+    }
+  }
+  std::ostream &out = outFile.is_open() ? outFile : std::cout;
+  life::writeResultHeader(out);
+
+  const auto start = std::chrono::steady_clock::now();
+  life::WorkStealingPool pool(threads);
+  std::mutex outMutex;
+  pool.run(static_cast<int>(jobs->size()), [&](const int index) {
+    const life::BatchResult result = life::runJob((*jobs)[index]);
+    std::lock_guard<std::mutex> lock(outMutex);
+    life::writeResult(out, index, (*jobs)[index], result);
+    out.flush();
+  });
+  const double seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+  std::cerr << jobs->size() << " jobs on " << pool.size() << " threads in "
+            << seconds << " s" << std::endl;
+  return out ? 0 : 1;
+}
@@ -0,0 +1,313 @@
+// life_bench.cpp
+//
+// Headless benchmarks for the engine. Every benchmark reports gens/s or
+// edits/s and cells/ns so runs on different board sizes can be compared
+// directly, e.g.
+//
+//   life_bench --benchmark_filter=Iterate --benchmark_counters_tabular=true
+#include "life.hpp"
+#include "ThreadPool.hpp"
+#include "sparseboard.hpp"
+#include "tiledboard.hpp"
+
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+enum Seed : int64_t { RANDOM = 0, GLIDERS = 1 };
+
+// Densities are given in percent so they can travel as benchmark arguments.
+life::GameBoard seededBoard(const int size, const int density,
+                            const int64_t seed) {
+  life::GameBoard board = life::genBoard(size, size);
+  if (seed == RANDOM) {
+    life::seedBoard(board, density / 100.0, 12345);
+    return board;
+  }
+  // A field of gliders on an 8x8 lattice, one in every 100/density cells.
+  const int stride = 8;
+  const int skip = density > 0 ? 100 / density : size;
+  int placed = 0;
+  for (int y = 1; y + 3 < size; y += stride) {
+    for (int x = 1; x + 3 < size; x += stride) {
+      if (placed++ % skip != 0) {
+        continue;
+      }
+      life::setCellState(board, x + 1, y, life::ALIVE);
+      life::setCellState(board, x + 2, y + 1, life::ALIVE);
+      life::setCellState(board, x, y + 2, life::ALIVE);
+      life::setCellState(board, x + 1, y + 2, life::ALIVE);
+      life::setCellState(board, x + 2, y + 2, life::ALIVE);
+    }
+  }
+  return board;
+}
+
+void reportRates(benchmark::State &state, const int size, const char *unit) {
+  const double cells = static_cast<double>(size) * size;
+  state.counters[unit] = benchmark::Counter(
+      static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+  // kIsRate divides by seconds, so scale to get cells per nanosecond.
+  state.counters["cells/ns"] =
+      benchmark::Counter(cells * state.iterations() / 1e9,
+                         benchmark::Counter::kIsRate);
+}
+
+// Args: size, density, seed.
+void boardArgs(benchmark::internal::Benchmark *bench) {
+  bench->ArgNames({"size", "density", "seed"});
+  for (const int size : {100, 1024, 4096, 16384}) {
+    for (const int density : {10, 35, 50}) {
+      bench->Args({size, density, RANDOM});
+    }
+    bench->Args({size, 25, GLIDERS});
+  }
+  bench->Unit(benchmark::kMillisecond);
+}
+
+void sizeArgs(benchmark::internal::Benchmark *bench) {
+  bench->ArgNames({"size"});
+  for (const int size : {100, 1024, 4096, 16384}) {
+    bench->Args({size});
+  }
+  bench->Unit(benchmark::kMillisecond);
+}
+
+void BM_GenBoard(benchmark::State &state) {
+  const int size = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    life::GameBoard board = life::genBoard(size, size);
+    benchmark::DoNotOptimize(board.board.data());
+  }
+  reportRates(state, size, "boards/s");
+}
+BENCHMARK(BM_GenBoard)->Apply(sizeArgs);
+
+void BM_SeedBoard(benchmark::State &state) {
+  const int size = static_cast<int>(state.range(0));
+  life::GameBoard board = life::genBoard(size, size);
+  std::uint64_t seed = 0;
+  for (auto _ : state) {
+    life::seedBoard(board, 0.35, seed++);
+    benchmark::DoNotOptimize(board.board.data());
+  }
+  reportRates(state, size, "boards/s");
+}
+BENCHMARK(BM_SeedBoard)->Apply(sizeArgs);
+
+void BM_SeedBoardParallel(benchmark::State &state) {
+  const int size = static_cast<int>(state.range(0));
+  life::ThreadPool pool;
+  life::GameBoard board = life::genBoard(size, size);
+  std::uint64_t seed = 0;
+  for (auto _ : state) {
+    life::seedBoard(board, 0.35, seed++, pool);
+    benchmark::DoNotOptimize(board.board.data());
+  }
+  reportRates(state, size, "boards/s");
+}
+BENCHMARK(BM_SeedBoardParallel)->Apply(sizeArgs)->UseRealTime();
+
+void BM_SetCellState(benchmark::State &state) {
+  const int size = static_cast<int>(state.range(0));
+  life::GameBoard board = life::genBoard(size, size);
+  std::mt19937 rng(1);
+  std::uniform_int_distribution<int> coord(0, size - 1);
+  for (auto _ : state) {
+    // Toggle so the board neither fills up nor empties out.
+    const int x = coord(rng);
+    const int y = coord(rng);
+    life::setCellState(board, x, y,
+                       life::getCellState(board, x, y) == life::ALIVE
+                           ? life::DEAD
+                           : life::ALIVE);
+  }
+  state.counters["edits/s"] = benchmark::Counter(
+      static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_SetCellState)->ArgNames({"size"})->Arg(100)->Arg(4096)->Arg(16384);
+
+// The same toggles on the tiled layout, where a cell's neighbours share
+// its tile but for the tile's edges rather than lying a row apart. On
+// the wide boards each row-major edit touches three rows 16 KiB apart; a
+// build of the benchmark library with libpfm can show the difference in
+// cache misses with --benchmark_perf_counters=CYCLES,LLC-load-misses.
+void BM_SetCellStateTiled(benchmark::State &state) {
+  const int size = static_cast<int>(state.range(0));
+  life::TiledBoard board = life::genTiledBoard(size, size);
+  std::mt19937 rng(1);
+  std::uniform_int_distribution<int> coord(0, size - 1);
+  for (auto _ : state) {
+    const int x = coord(rng);
+    const int y = coord(rng);
+    life::setCellState(board, x, y,
+                       life::getCellState(board, x, y) == life::ALIVE
+                           ? life::DEAD
+                           : life::ALIVE);
+  }
+  state.counters["edits/s"] = benchmark::Counter(
+      static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_SetCellStateTiled)
+    ->ArgNames({"size"})
+    ->Arg(100)
+    ->Arg(4096)
+    ->Arg(16384);
+
+// Args: size, writes per batch, batched. Each batch writes a square patch
+// at a random spot, as pasting a pattern or a brush stroke does, with
+// setCellStates or one setCellState per write.
+void BM_EditBatch(benchmark::State &state) {
+  const int size = static_cast<int>(state.range(0));
+  const int count = static_cast<int>(state.range(1));
+  const bool batched = state.range(2) != 0;
+  life::GameBoard board = seededBoard(size, 35, RANDOM);
+  int side = 1;
+  while (side * side < count) {
+    side++;
+  }
+  std::mt19937 rng(1);
+  std::uniform_int_distribution<int> corner(0, size - side);
+  std::vector<life::CellWrite> writes(count);
+  for (auto _ : state) {
+    state.PauseTiming();
+    const int x = corner(rng);
+    const int y = corner(rng);
+    for (int i = 0; i < count; i++) {
+      writes[i] = {x + i % side, y + i / side, static_cast<char>(rng() % 2)};
+    }
+    state.ResumeTiming();
+    if (batched) {
+      life::setCellStates(board, writes);
+    } else {
+      for (const life::CellWrite &write : writes) {
+        life::setCellState(board, write.x, write.y, write.state);
+      }
+    }
+  }
+  state.counters["edits/s"] =
+      benchmark::Counter(static_cast<double>(state.iterations()) * count,
+                         benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_EditBatch)
+    ->ArgNames({"size", "writes", "batched"})
+    ->ArgsProduct({{1024, 4096}, {16, 256, 4096, 65536}, {0, 1}});
+
+void BM_IterateBoard(benchmark::State &state) {
+  const int size = static_cast<int>(state.range(0));
+  life::GameBoard board = seededBoard(size, static_cast<int>(state.range(1)),
+                                      state.range(2));
+  for (auto _ : state) {
+    life::iterateBoard(board);
+  }
+  reportRates(state, size, "gens/s");
+}
+BENCHMARK(BM_IterateBoard)->Apply(boardArgs);
+
+void BM_IterateBoardParallel(benchmark::State &state) {
+  const int size = static_cast<int>(state.range(0));
+  life::GameBoard board = seededBoard(size, static_cast<int>(state.range(1)),
+                                      state.range(2));
+  life::ThreadPool pool;
+  for (auto _ : state) {
+    life::iterateBoard(board, pool);
+  }
+  reportRates(state, size, "gens/s");
+}
+BENCHMARK(BM_IterateBoardParallel)->Apply(boardArgs)->UseRealTime();
+
+void BM_IterateBoardSparse(benchmark::State &state) {
+  const int size = static_cast<int>(state.range(0));
+  life::GameBoard board = seededBoard(size, static_cast<int>(state.range(1)),
+                                      state.range(2));
+  for (auto _ : state) {
+    life::iterateBoardSparse(board);
+  }
+  reportRates(state, size, "gens/s");
+}
+BENCHMARK(BM_IterateBoardSparse)->Apply(boardArgs);
+
+void BM_IterateTiledBoard(benchmark::State &state) {
+  const int size = static_cast<int>(state.range(0));
+  life::TiledBoard board = life::toTiledBoard(seededBoard(
+      size, static_cast<int>(state.range(1)), state.range(2)));
+  for (auto _ : state) {
+    life::iterateBoard(board);
+  }
+  reportRates(state, size, "gens/s");
+}
+BENCHMARK(BM_IterateTiledBoard)->Apply(boardArgs);
+
+void BM_IterateTiledBoardParallel(benchmark::State &state) {
+  const int size = static_cast<int>(state.range(0));
+  life::TiledBoard board = life::toTiledBoard(seededBoard(
+      size, static_cast<int>(state.range(1)), state.range(2)));
+  life::ThreadPool pool;
+  for (auto _ : state) {
+    life::iterateBoard(board, pool);
+  }
+  reportRates(state, size, "gens/s");
+}
+BENCHMARK(BM_IterateTiledBoardParallel)->Apply(boardArgs)->UseRealTime();
+
+// Args: size, density, seed. The unbounded plane, started from the same
+// boards; gliders leaving the pattern create and free tiles every step.
+void BM_IterateSparsePlane(benchmark::State &state) {
+  const int size = static_cast<int>(state.range(0));
+  life::SparseBoard board = life::toSparseBoard(seededBoard(
+      size, static_cast<int>(state.range(1)), state.range(2)));
+  for (auto _ : state) {
+    life::iterateBoard(board);
+  }
+  reportRates(state, size, "gens/s");
+  state.counters["tiles"] = static_cast<double>(board.tiles.size());
+}
+BENCHMARK(BM_IterateSparsePlane)
+    ->ArgNames({"size", "density", "seed"})
+    ->ArgsProduct({{256, 1024}, {25}, {RANDOM, GLIDERS}});
+
+// Args: size, boundary (0 dead, 1 torus, 2 Klein bottle), parallel. Only the
+// edge cells see the boundary, so the modes should be within a few percent.
+void BM_IterateBoardBoundary(benchmark::State &state) {
+  const int size = static_cast<int>(state.range(0));
+  life::GameBoard board = seededBoard(size, 25, RANDOM);
+  life::setBoundary(board, static_cast<life::Boundary>(state.range(1)));
+  life::ThreadPool pool;
+  for (auto _ : state) {
+    if (state.range(2)) {
+      life::iterateBoard(board, pool);
+    } else {
+      life::iterateBoard(board);
+    }
+  }
+  reportRates(state, size, "gens/s");
+}
+BENCHMARK(BM_IterateBoardBoundary)
+    ->ArgNames({"size", "boundary", "parallel"})
+    ->ArgsProduct({{256, 4096}, {0, 1, 2}, {0, 1}})
+    ->UseRealTime();
+
+// The renderer's hot loop: walk every live cell once.
+void BM_AliveListTraversal(benchmark::State &state) {
+  const int size = static_cast<int>(state.range(0));
+  life::GameBoard board = seededBoard(size, static_cast<int>(state.range(1)),
+                                      state.range(2));
+  for (auto _ : state) {
+    std::int64_t sum = 0;
+    const life::AliveList &alive = board.aliveList;
+    for (std::size_t i = 0; i < alive.size(); i++) {
+      sum += alive.x[i] + alive.y[i];
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  reportRates(state, size, "passes/s");
+  state.counters["alive"] = static_cast<double>(board.aliveList.size());
+}
+BENCHMARK(BM_AliveListTraversal)->Apply(boardArgs);
+
+} // namespace
+
+BENCHMARK_MAIN();
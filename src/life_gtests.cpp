@@ -1,6 +1,64 @@
+#include "Arena.hpp"
+#include "CycleDetector.hpp"
+#include "HashLife.hpp"
+#include "Shard.hpp"
+#include "Simulation.hpp"
+#include "ThreadPool.hpp"
+#include "TripleBuffer.hpp"
+#include "WorkStealingPool.hpp"
+#include "batch.hpp"
+#include "bitboard.hpp"
 #include "life.hpp" // Your existing life game header
+#include "pattern.hpp"
+#include "snapshot.hpp"
+#include "sparseboard.hpp"
+#include "tiledboard.hpp"
 #include "gtest/gtest.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream> // Keep for printBoard if desired for debugging
+#include <iterator>
+#include <memory>
+#include <new>
+#include <random>
+#include <sstream>
+#include <thread>
+
+// Count heap allocations so tests can assert the stepping hot loop does not
+// allocate.
+static std::atomic<long> allocationCount{0};
+
+// The replacements are kept out of line, and every ordinary form of new
+// and delete is replaced: once malloc() or free() is inlined into a caller,
+// g++ sees them paired with the other side's operator and warns of a
+// mismatch.
+__attribute__((noinline)) void *operator new(std::size_t size) {
+  allocationCount++;
+  if (void *p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+__attribute__((noinline)) void *operator new[](std::size_t size) {
+  return operator new(size);
+}
+__attribute__((noinline)) void operator delete(void *p) noexcept {
+  std::free(p);
+}
+__attribute__((noinline)) void operator delete(void *p, std::size_t) noexcept {
+  std::free(p);
+}
+__attribute__((noinline)) void operator delete[](void *p) noexcept {
+  std::free(p);
+}
+__attribute__((noinline)) void operator delete[](void *p,
+                                                 std::size_t) noexcept {
+  std::free(p);
+}
 
 // Test fixture for LifeGame tests, if needed for common setup/teardown
 // For these tests, a fixture isn't strictly necessary yet, so we'll use TEST
@@ -150,6 +208,1886 @@ TEST(LifeGameTests, IterateBoard) {
   EXPECT_EQ(6, gameBoard.aliveList.size());
 }
 
+// The alive list's cells in row-major order, for comparing lists whose
+// order legitimately differs.
+static life::CellList sortedByRow(const life::AliveList &aliveList) {
+  life::CellList cells;
+  for (std::size_t i = 0; i < aliveList.size(); i++) {
+    cells.emplace_back(aliveList.y[i], aliveList.x[i]);
+  }
+  std::sort(cells.begin(), cells.end());
+  return cells;
+}
+
+TEST(LifeGameTests, RepeatedAliveWritesAreIdempotent) {
+  life::GameBoard gameBoard = life::genBoard(5, 5);
+  life::setCellState(gameBoard, 2, 2, life::ALIVE);
+  life::setCellState(gameBoard, 2, 2, life::ALIVE);
+  EXPECT_EQ(1, gameBoard.aliveList.size());
+  EXPECT_EQ(1, life::neighborCount(gameBoard, 1, 1));
+}
+
+TEST(LifeGameTests, DeadWriteClearsCell) {
+  life::GameBoard gameBoard = life::genBoard(5, 5);
+  life::setCellState(gameBoard, 1, 1, life::ALIVE);
+  life::setCellState(gameBoard, 2, 2, life::ALIVE);
+  life::setCellState(gameBoard, 3, 3, life::ALIVE);
+  life::setCellState(gameBoard, 1, 1, life::DEAD);
+  EXPECT_EQ(life::DEAD, life::getCellState(gameBoard, 1, 1));
+  EXPECT_EQ(0, life::neighborCount(gameBoard, 0, 0));
+  EXPECT_EQ(1, life::neighborCount(gameBoard, 1, 2));
+  ASSERT_EQ(2, gameBoard.aliveList.size());
+  EXPECT_EQ(3, gameBoard.aliveList.x[0]);
+  EXPECT_EQ(2, gameBoard.aliveList.x[1]);
+  // The entry moved into the freed place is still found.
+  life::setCellState(gameBoard, 3, 3, life::DEAD);
+  EXPECT_EQ(1, gameBoard.aliveList.size());
+  EXPECT_EQ(2, gameBoard.aliveList.x[0]);
+  EXPECT_EQ(2, gameBoard.aliveList.y[0]);
+
+  // Matches a board that never had the cleared cells.
+  life::GameBoard expected = life::genBoard(5, 5);
+  life::setCellState(expected, 2, 2, life::ALIVE);
+  EXPECT_EQ(expected.board, gameBoard.board);
+}
+
+TEST(LifeGameTests, IterateBoardSteadyStateDoesNotAllocate) {
+  life::GameBoard gameBoard = life::genBoard(32, 32);
+  // Blinker, period 2, so the alive list never needs to grow.
+  life::setCellState(gameBoard, 10, 10, life::ALIVE);
+  life::setCellState(gameBoard, 11, 10, life::ALIVE);
+  life::setCellState(gameBoard, 12, 10, life::ALIVE);
+  // Warm up so the back buffer and alive list have their capacity.
+  life::iterateBoard(gameBoard);
+  life::iterateBoard(gameBoard);
+
+  const long before = allocationCount.load();
+  for (int i = 0; i < 100; i++) {
+    life::iterateBoard(gameBoard);
+  }
+  EXPECT_EQ(before, allocationCount.load());
+  EXPECT_EQ(3, gameBoard.aliveList.size());
+  EXPECT_EQ(life::ALIVE, life::getCellState(gameBoard, 10, 10));
+  EXPECT_EQ(life::ALIVE, life::getCellState(gameBoard, 12, 10));
+}
+
+// The original cell-by-cell stepping, kept as the reference the fast kernels
+// must match byte for byte.
+static life::GameBoard referenceIterate(const life::GameBoard &gameBoard) {
+  life::GameBoard next = life::genBoard(gameBoard.height, gameBoard.width);
+  for (int y = 0; y < gameBoard.height; y++) {
+    for (int x = 0; x < gameBoard.width; x++) {
+      int count = life::neighborCount(gameBoard, x, y);
+      if (count == 3 ||
+          (count == 2 && life::getCellState(gameBoard, x, y) == life::ALIVE)) {
+        life::setCellState(next, x, y, life::ALIVE);
+      }
+    }
+  }
+  return next;
+}
+
+static life::GameBoard randomBoard(int height, int width, unsigned seed) {
+  life::GameBoard gameBoard = life::genBoard(height, width);
+  std::mt19937 rng(seed);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      if (rng() % 3 == 0) {
+        life::setCellState(gameBoard, x, y, life::ALIVE);
+      }
+    }
+  }
+  return gameBoard;
+}
+
+TEST(LifeGameTests, IterateBoardMatchesReference) {
+  const int sizes[][2] = {{1, 1}, {2, 5}, {3, 3}, {17, 9}, {64, 64}, {61, 130}};
+  for (const auto &size : sizes) {
+    life::GameBoard gameBoard = randomBoard(size[0], size[1], size[0] * 31 + size[1]);
+    for (int generation = 0; generation < 20; generation++) {
+      life::GameBoard expected = referenceIterate(gameBoard);
+      life::iterateBoard(gameBoard);
+      ASSERT_EQ(expected.board, gameBoard.board)
+          << size[0] << "x" << size[1] << " generation " << generation;
+      ASSERT_EQ(expected.aliveList, gameBoard.aliveList);
+    }
+  }
+}
+
+TEST(ThreadPoolTests, RunsEveryTaskOnce) {
+  life::ThreadPool pool(4);
+  EXPECT_EQ(4, pool.size());
+  std::vector<std::atomic<int>> hits(100);
+  for (int round = 0; round < 50; round++) {
+    pool.run(static_cast<int>(hits.size()), [&](int i) { hits[i]++; });
+  }
+  for (auto &hit : hits) {
+    EXPECT_EQ(50, hit.load());
+  }
+}
+
+TEST(LifeGameTests, ParallelIterateBoardMatchesSerial) {
+  const int sizes[][2] = {{1, 1}, {2, 7}, {5, 5}, {37, 41}, {128, 96}};
+  for (int threads : {1, 2, 3, 8}) {
+    life::ThreadPool pool(threads);
+    for (const auto &size : sizes) {
+      life::GameBoard serial = randomBoard(size[0], size[1], threads * size[0]);
+      life::GameBoard parallel = serial;
+      for (int generation = 0; generation < 15; generation++) {
+        life::iterateBoard(serial);
+        life::iterateBoard(parallel, pool);
+        ASSERT_EQ(serial.board, parallel.board)
+            << threads << " threads " << size[0] << "x" << size[1];
+        ASSERT_EQ(serial.aliveList, parallel.aliveList);
+      }
+    }
+  }
+}
+
+TEST(LifeGameTests, EditsAfterIterateKeepAliveListExact) {
+  life::ThreadPool pool(3);
+  for (const bool parallel : {false, true}) {
+    life::GameBoard gameBoard = randomBoard(40, 40, 9);
+    parallel ? life::iterateBoard(gameBoard, pool) : life::iterateBoard(gameBoard);
+    // Clear every other live cell, write some live ones twice.
+    const life::AliveList snapshot = gameBoard.aliveList;
+    for (std::size_t i = 0; i < snapshot.size(); i += 2) {
+      life::setCellState(gameBoard, snapshot.x[i], snapshot.y[i], life::DEAD);
+      life::setCellState(gameBoard, snapshot.x[i], snapshot.y[i], life::DEAD);
+    }
+    for (std::size_t i = 1; i < snapshot.size(); i += 2) {
+      life::setCellState(gameBoard, snapshot.x[i], snapshot.y[i], life::ALIVE);
+    }
+    life::setCellState(gameBoard, 0, 0, life::ALIVE);
+
+    life::GameBoard expected = life::genBoard(40, 40);
+    for (int y = 0; y < 40; y++) {
+      for (int x = 0; x < 40; x++) {
+        if (life::getCellState(gameBoard, x, y) == life::ALIVE) {
+          life::setCellState(expected, x, y, life::ALIVE);
+        }
+      }
+    }
+    EXPECT_EQ(expected.board, gameBoard.board);
+    EXPECT_EQ(sortedByRow(expected.aliveList), sortedByRow(gameBoard.aliveList));
+  }
+}
+
+TEST(LifeGameTests, ManyTogglesKeepAliveListExact) {
+  // Enough writes to grow the removal table several times, with removals
+  // landing in the middle of its probe runs.
+  life::GameBoard gameBoard = life::genBoard(64, 64);
+  std::mt19937 rng(11);
+  std::uniform_int_distribution<int> coordinate(0, 63);
+  for (int i = 0; i < 20000; i++) {
+    const int x = coordinate(rng);
+    const int y = coordinate(rng);
+    life::setCellState(gameBoard, x, y,
+                       life::getCellState(gameBoard, x, y) == life::ALIVE
+                           ? life::DEAD
+                           : life::ALIVE);
+    if (i % 5000 == 4999) {
+      life::iterateBoard(gameBoard);
+    }
+  }
+  life::GameBoard expected = life::genBoard(64, 64);
+  for (int y = 0; y < 64; y++) {
+    for (int x = 0; x < 64; x++) {
+      if (life::getCellState(gameBoard, x, y) == life::ALIVE) {
+        life::setCellState(expected, x, y, life::ALIVE);
+      }
+    }
+  }
+  EXPECT_EQ(sortedByRow(expected.aliveList), sortedByRow(gameBoard.aliveList));
+}
+
+TEST(LifeGameTests, BorderOscillatorLeavesNoStaleSlots) {
+  // A blinker on the top edge flips border cells every generation.
+  life::GameBoard gameBoard = life::genBoard(10, 10);
+  for (int y = 0; y < 3; y++) {
+    life::setCellState(gameBoard, 5, y, life::ALIVE);
+  }
+  for (int i = 0; i < 3; i++) {
+    life::iterateBoard(gameBoard);
+  }
+  life::setCellState(gameBoard, 9, 9, life::ALIVE);
+  ASSERT_EQ(life::DEAD, life::getCellState(gameBoard, 5, 0));
+  life::setCellState(gameBoard, 5, 0, life::ALIVE);
+  life::setCellState(gameBoard, 5, 1, life::DEAD);
+  life::setCellState(gameBoard, 9, 9, life::DEAD);
+  life::GameBoard expected = life::genBoard(10, 10);
+  life::setCellState(expected, 4, 1, life::ALIVE);
+  life::setCellState(expected, 6, 1, life::ALIVE);
+  life::setCellState(expected, 5, 0, life::ALIVE);
+  EXPECT_EQ(sortedByRow(expected.aliveList), sortedByRow(gameBoard.aliveList));
+}
+
+TEST(RuleTests, ParseRule) {
+  EXPECT_EQ(life::CONWAY, life::parseRule("B3/S23"));
+  EXPECT_EQ(life::CONWAY, life::parseRule("b3/s23"));
+  EXPECT_EQ(life::CONWAY, life::parseRule("S23/B3"));
+  EXPECT_EQ(life::HIGHLIFE, life::parseRule("B36/S23"));
+  EXPECT_EQ(life::SEEDS, life::parseRule("B2/S"));
+  EXPECT_EQ(life::DAY_AND_NIGHT, life::parseRule("B3678/S34678"));
+  EXPECT_EQ(life::Rule({(1 << 0) | (1 << 1), 1 << 8}), life::parseRule("B01S8"));
+  EXPECT_FALSE(life::parseRule(""));
+  EXPECT_FALSE(life::parseRule("B3"));
+  EXPECT_FALSE(life::parseRule("B3/S29"));
+  EXPECT_FALSE(life::parseRule("B3/B3/S23"));
+  EXPECT_FALSE(life::parseRule("23/3"));
+  EXPECT_FALSE(life::parseRule("B3/S23/"));
+  EXPECT_EQ("B3/S23", life::ruleString(life::CONWAY));
+  EXPECT_EQ("B3678/S34678", life::ruleString(life::DAY_AND_NIGHT));
+  EXPECT_EQ("B2/S", life::ruleString(life::SEEDS));
+}
+
+TEST(RuleTests, PackedMaskMatchesConwayKernel) {
+  EXPECT_EQ(0xE0u, life::Conway::NEXT);
+}
+
+// Steps a copy of the board under rule and returns it.
+static life::GameBoard stepped(life::GameBoard gameBoard, const life::Rule &rule,
+                               int generations = 1) {
+  life::setRule(gameBoard, rule);
+  for (int i = 0; i < generations; i++) {
+    life::iterateBoard(gameBoard);
+  }
+  return gameBoard;
+}
+
+TEST(RuleTests, HighLifeBirthOnSix) {
+  life::GameBoard gameBoard = life::genBoard(9, 9);
+  const int ring[][2] = {{3, 3}, {4, 3}, {5, 3}, {3, 4}, {5, 4}, {3, 5}};
+  for (const auto &cell : ring) {
+    life::setCellState(gameBoard, cell[0], cell[1], life::ALIVE);
+  }
+  EXPECT_EQ(life::ALIVE,
+            life::getCellState(stepped(gameBoard, life::HIGHLIFE), 4, 4));
+  EXPECT_EQ(life::DEAD,
+            life::getCellState(stepped(gameBoard, life::CONWAY), 4, 4));
+}
+
+TEST(RuleTests, HighLifeReplicatorCopiesItself) {
+  // The HighLife replicator doubles after 12 generations.
+  life::GameBoard gameBoard = life::genBoard(64, 64);
+  const int cells[][2] = {{31, 30}, {32, 30}, {33, 30}, {30, 31}, {33, 31},
+                          {29, 32}, {33, 32}, {29, 33}, {32, 33}, {29, 34},
+                          {30, 34}, {31, 34}};
+  for (const auto &cell : cells) {
+    life::setCellState(gameBoard, cell[0], cell[1], life::ALIVE);
+  }
+  EXPECT_EQ(24u, stepped(gameBoard, life::HIGHLIFE, 12).aliveList.size());
+  EXPECT_NE(24u, stepped(gameBoard, life::CONWAY, 12).aliveList.size());
+}
+
+TEST(RuleTests, SeedsKillsEveryLiveCell) {
+  life::GameBoard gameBoard = life::genBoard(9, 9);
+  life::setCellState(gameBoard, 4, 4, life::ALIVE);
+  life::setCellState(gameBoard, 5, 4, life::ALIVE);
+  const life::GameBoard next = stepped(gameBoard, life::SEEDS);
+  EXPECT_EQ(4, next.aliveList.size());
+  EXPECT_EQ(life::DEAD, life::getCellState(next, 4, 4));
+  EXPECT_EQ(life::ALIVE, life::getCellState(next, 4, 3));
+  EXPECT_EQ(life::ALIVE, life::getCellState(next, 5, 3));
+  EXPECT_EQ(life::ALIVE, life::getCellState(next, 4, 5));
+  EXPECT_EQ(life::ALIVE, life::getCellState(next, 5, 5));
+}
+
+TEST(RuleTests, DayAndNightBlockIsStableAndEightFillsHole) {
+  life::GameBoard block = life::genBoard(8, 8);
+  life::setCellState(block, 3, 3, life::ALIVE);
+  life::setCellState(block, 4, 3, life::ALIVE);
+  life::setCellState(block, 3, 4, life::ALIVE);
+  life::setCellState(block, 4, 4, life::ALIVE);
+  EXPECT_EQ(block.board, stepped(block, life::DAY_AND_NIGHT, 5).board);
+
+  life::GameBoard ring = life::genBoard(9, 9);
+  for (int y = 3; y <= 5; y++) {
+    for (int x = 3; x <= 5; x++) {
+      if (x != 4 || y != 4) {
+        life::setCellState(ring, x, y, life::ALIVE);
+      }
+    }
+  }
+  EXPECT_EQ(life::ALIVE,
+            life::getCellState(stepped(ring, life::DAY_AND_NIGHT), 4, 4));
+  EXPECT_EQ(life::DEAD, life::getCellState(stepped(ring, life::CONWAY), 4, 4));
+}
+
+// Reference stepping for any rule.
+static life::GameBoard referenceIterate(const life::GameBoard &gameBoard,
+                                        const life::Rule &rule) {
+  life::GameBoard next = life::genBoard(gameBoard.height, gameBoard.width);
+  for (int y = 0; y < gameBoard.height; y++) {
+    for (int x = 0; x < gameBoard.width; x++) {
+      const int count = life::neighborCount(gameBoard, x, y);
+      const bool alive = life::getCellState(gameBoard, x, y) == life::ALIVE;
+      if ((alive ? rule.survive : rule.birth) & (1 << count)) {
+        life::setCellState(next, x, y, life::ALIVE);
+      }
+    }
+  }
+  return next;
+}
+
+TEST(RuleTests, EveryKernelMatchesReference) {
+  life::ThreadPool pool(3);
+  const life::Rule rules[] = {life::CONWAY, life::HIGHLIFE, life::SEEDS,
+                              life::DAY_AND_NIGHT, *life::parseRule("B0/S8"),
+                              *life::parseRule("B35/S2456")};
+  for (const auto &rule : rules) {
+    life::GameBoard serial = randomBoard(45, 67, rule.birth);
+    life::setRule(serial, rule);
+    life::GameBoard parallel = serial;
+    life::GameBoard sparse = serial;
+    for (int generation = 0; generation < 12; generation++) {
+      const life::GameBoard expected = referenceIterate(serial, rule);
+      life::iterateBoard(serial);
+      life::iterateBoard(parallel, pool);
+      life::iterateBoardSparse(sparse);
+      ASSERT_EQ(expected.board, serial.board) << life::ruleString(rule);
+      ASSERT_EQ(expected.aliveList, serial.aliveList);
+      ASSERT_EQ(expected.board, parallel.board) << life::ruleString(rule);
+      ASSERT_EQ(expected.board, sparse.board) << life::ruleString(rule);
+    }
+  }
+}
+
+TEST(LifeGameTests, SparseIterateBoardMatchesDense) {
+  const int sizes[][2] = {{1, 1}, {3, 3}, {31, 33}, {64, 64}, {100, 70}};
+  for (const auto &size : sizes) {
+    life::GameBoard dense = randomBoard(size[0], size[1], size[0] * size[1]);
+    life::GameBoard sparse = dense;
+    for (int generation = 0; generation < 40; generation++) {
+      life::iterateBoard(dense);
+      life::iterateBoardSparse(sparse);
+      ASSERT_EQ(dense.board, sparse.board)
+          << size[0] << "x" << size[1] << " generation " << generation;
+      ASSERT_EQ(sortedByRow(dense.aliveList), sortedByRow(sparse.aliveList));
+    }
+  }
+}
+
+TEST(LifeGameTests, SparseIterateBoardSkipsStableTiles) {
+  life::GameBoard gameBoard = life::genBoard(256, 256);
+  // A blinker well inside tile (2, 2) and a block inside tile (6, 6).
+  life::setCellState(gameBoard, 80, 80, life::ALIVE);
+  life::setCellState(gameBoard, 81, 80, life::ALIVE);
+  life::setCellState(gameBoard, 82, 80, life::ALIVE);
+  life::setCellState(gameBoard, 200, 200, life::ALIVE);
+  life::setCellState(gameBoard, 201, 200, life::ALIVE);
+  life::setCellState(gameBoard, 200, 201, life::ALIVE);
+  life::setCellState(gameBoard, 201, 201, life::ALIVE);
+
+  life::iterateBoardSparse(gameBoard);
+  EXPECT_EQ(64, gameBoard.tiles.activeCount);
+  for (int generation = 0; generation < 10; generation++) {
+    life::iterateBoardSparse(gameBoard);
+    // Only the blinker's tile and its neighbours are revisited.
+    EXPECT_EQ(9, gameBoard.tiles.activeCount);
+  }
+  EXPECT_EQ(7, gameBoard.aliveList.size());
+
+  // A manual edit wakes its tile, on the left edge, and its neighbours.
+  life::setCellState(gameBoard, 10, 200, life::ALIVE);
+  life::iterateBoardSparse(gameBoard);
+  EXPECT_EQ(9 + 6, gameBoard.tiles.activeCount);
+  EXPECT_EQ(life::DEAD, life::getCellState(gameBoard, 10, 200));
+}
+
+// Births and deaths between two boards, in row-major order.
+static void boardDiff(const life::GameBoard &before,
+                      const life::GameBoard &after, life::CellList &births,
+                      life::CellList &deaths) {
+  births.clear();
+  deaths.clear();
+  for (int y = 0; y < before.height; y++) {
+    for (int x = 0; x < before.width; x++) {
+      const char was = life::getCellState(before, x, y);
+      const char is = life::getCellState(after, x, y);
+      if (was != is) {
+        (is == life::ALIVE ? births : deaths).emplace_back(y, x);
+      }
+    }
+  }
+}
+
+static life::CellList sortedByRow(life::CellList cells) {
+  for (auto &cell : cells) {
+    std::swap(cell.first, cell.second);
+  }
+  std::sort(cells.begin(), cells.end());
+  return cells;
+}
+
+TEST(ChangeListTests, EveryStepListsExactBirthsAndDeaths) {
+  life::ThreadPool pool(3);
+  for (int kernel = 0; kernel < 3; kernel++) {
+    // Sparse enough that a generation's changes stay under the full limit.
+    life::GameBoard gameBoard = life::genBoard(90, 70);
+    std::mt19937 rng(kernel);
+    for (int i = 0; i < 400; i++) {
+      life::setCellState(gameBoard, rng() % 70, rng() % 90, life::ALIVE);
+    }
+    life::trackChanges(gameBoard, true);
+    life::CellList births;
+    life::CellList deaths;
+    for (int generation = 0; generation < 30; generation++) {
+      life::clearChanges(gameBoard);
+      const life::GameBoard before = gameBoard;
+      if (kernel == 0) {
+        life::iterateBoard(gameBoard);
+      } else if (kernel == 1) {
+        life::iterateBoard(gameBoard, pool);
+      } else {
+        life::iterateBoardSparse(gameBoard);
+      }
+      boardDiff(before, gameBoard, births, deaths);
+      ASSERT_FALSE(gameBoard.changes.full) << kernel << " " << generation;
+      ASSERT_EQ(births, sortedByRow(gameBoard.changes.births))
+          << kernel << " " << generation;
+      ASSERT_EQ(deaths, sortedByRow(gameBoard.changes.deaths))
+          << kernel << " " << generation;
+    }
+  }
+}
+
+TEST(ChangeListTests, EditsAreListedAndNoOpsAreNot) {
+  life::GameBoard gameBoard = life::genBoard(10, 10);
+  life::trackChanges(gameBoard, true);
+  EXPECT_TRUE(gameBoard.changes.full);
+  life::clearChanges(gameBoard);
+  life::setCellState(gameBoard, 3, 4, life::ALIVE);
+  life::setCellState(gameBoard, 3, 4, life::ALIVE);
+  life::setCellState(gameBoard, 5, 5, life::DEAD);
+  EXPECT_EQ(life::CellList({{3, 4}}), gameBoard.changes.births);
+  EXPECT_TRUE(gameBoard.changes.deaths.empty());
+  life::setCellState(gameBoard, 3, 4, life::DEAD);
+  EXPECT_EQ(life::CellList({{3, 4}}), gameBoard.changes.deaths);
+}
+
+TEST(ChangeListTests, DisabledOrOverflowingListsStayEmpty) {
+  life::GameBoard gameBoard = randomBoard(40, 40, 1);
+  life::iterateBoard(gameBoard);
+  EXPECT_TRUE(gameBoard.changes.births.empty());
+  EXPECT_TRUE(gameBoard.changes.deaths.empty());
+
+  // A random soup flips far more than a quarter of the board at once.
+  life::trackChanges(gameBoard, true);
+  life::clearChanges(gameBoard);
+  life::iterateBoard(gameBoard);
+  EXPECT_TRUE(gameBoard.changes.full);
+  EXPECT_TRUE(gameBoard.changes.births.empty());
+  EXPECT_TRUE(gameBoard.changes.deaths.empty());
+}
+
+TEST(BitBoardTests, GetSetCellState) {
+  life::BitBoard board = life::genBitBoard(10, 130);
+  life::setCellState(board, 0, 0, life::ALIVE);
+  life::setCellState(board, 64, 3, life::ALIVE);
+  life::setCellState(board, 129, 9, life::ALIVE);
+  EXPECT_EQ(life::ALIVE, life::getCellState(board, 0, 0));
+  EXPECT_EQ(life::ALIVE, life::getCellState(board, 64, 3));
+  EXPECT_EQ(life::ALIVE, life::getCellState(board, 129, 9));
+  EXPECT_EQ(life::DEAD, life::getCellState(board, 63, 3));
+  EXPECT_EQ(1, life::neighborCount(board, 65, 4));
+  EXPECT_EQ(3u, life::population(board));
+  life::setCellState(board, 64, 3, life::DEAD);
+  EXPECT_EQ(life::DEAD, life::getCellState(board, 64, 3));
+  EXPECT_EQ(2u, life::population(board));
+}
+
+TEST(BitBoardTests, ConvertsToAndFromGameBoard) {
+  life::GameBoard gameBoard = randomBoard(33, 70, 7);
+  life::GameBoard roundTrip = life::toGameBoard(life::toBitBoard(gameBoard));
+  EXPECT_EQ(gameBoard.board, roundTrip.board);
+  EXPECT_EQ(gameBoard.aliveList, roundTrip.aliveList);
+}
+
+TEST(BitBoardTests, IterateBoardMatchesGameBoard) {
+  // Widths straddle word and SIMD lane boundaries.
+  const int sizes[][2] = {{1, 1}, {3, 3}, {5, 63}, {9, 64}, {17, 65},
+                          {40, 128}, {31, 200}, {64, 257}, {20, 513}};
+  for (const auto &size : sizes) {
+    life::GameBoard gameBoard = randomBoard(size[0], size[1], size[0] + size[1]);
+    life::BitBoard bitBoard = life::toBitBoard(gameBoard);
+    for (int generation = 0; generation < 30; generation++) {
+      life::iterateBoard(gameBoard);
+      life::iterateBoard(bitBoard);
+      ASSERT_EQ(gameBoard.board, life::toGameBoard(bitBoard).board)
+          << size[0] << "x" << size[1] << " generation " << generation
+          << " backend " << life::bitBoardBackend();
+    }
+  }
+}
+
+static void addGlider(life::GameBoard &gameBoard, int x, int y) {
+  life::setCellState(gameBoard, x + 1, y, life::ALIVE);
+  life::setCellState(gameBoard, x + 2, y + 1, life::ALIVE);
+  life::setCellState(gameBoard, x, y + 2, life::ALIVE);
+  life::setCellState(gameBoard, x + 1, y + 2, life::ALIVE);
+  life::setCellState(gameBoard, x + 2, y + 2, life::ALIVE);
+}
+
+TEST(HashLifeTests, ImportExportRoundTrip) {
+  life::GameBoard gameBoard = randomBoard(45, 70, 3);
+  life::HashLife hashLife;
+  ASSERT_TRUE(hashLife.importBoard(gameBoard));
+  EXPECT_EQ(gameBoard.aliveList.size(), hashLife.population());
+  life::GameBoard exported = life::genBoard(45, 70);
+  hashLife.exportBoard(exported);
+  EXPECT_EQ(gameBoard.board, exported.board);
+}
+
+TEST(HashLifeTests, ExportKeepsTheBoardsSettings) {
+  life::GameBoard gameBoard = life::genBoard(16, 16);
+  addGlider(gameBoard, 4, 4);
+  life::HashLife hashLife;
+  ASSERT_TRUE(hashLife.importBoard(gameBoard));
+
+  life::GameBoard exported = randomBoard(16, 16, 7);
+  life::setRule(exported, life::HIGHLIFE);
+  life::trackChanges(exported, true);
+  life::trackHash(exported, true);
+  hashLife.exportBoard(exported);
+  EXPECT_EQ(gameBoard.board, exported.board);
+  EXPECT_EQ(sortedByRow(gameBoard.aliveList), sortedByRow(exported.aliveList));
+  EXPECT_TRUE(life::HIGHLIFE == exported.rule);
+  EXPECT_TRUE(exported.changes.enabled);
+  EXPECT_TRUE(exported.hashing);
+  EXPECT_EQ(life::boardHash(exported), exported.hash);
+}
+
+TEST(HashLifeTests, ImportRejectsOtherRules) {
+  life::GameBoard gameBoard = life::genBoard(16, 16);
+  addGlider(gameBoard, 4, 4);
+  life::HashLife hashLife;
+  ASSERT_TRUE(hashLife.importBoard(gameBoard));
+  life::GameBoard highLife = life::genBoard(16, 16);
+  life::setRule(highLife, life::HIGHLIFE);
+  life::setCellState(highLife, 0, 0, life::ALIVE);
+  EXPECT_FALSE(hashLife.importBoard(highLife));
+  EXPECT_EQ(5u, hashLife.population());
+}
+
+TEST(HashLifeTests, StepMatchesIterateBoard) {
+  // A small soup in the middle of a board big enough that nothing reaches
+  // the edge within the run.
+  life::GameBoard soup = randomBoard(16, 16, 11);
+  life::GameBoard gameBoard = life::genBoard(256, 256);
+  for (std::size_t i = 0; i < soup.aliveList.size(); i++) {
+    life::setCellState(gameBoard, 120 + soup.aliveList.x[i],
+                       120 + soup.aliveList.y[i], life::ALIVE);
+  }
+  addGlider(gameBoard, 100, 100);
+
+  life::HashLife hashLife;
+  hashLife.importBoard(gameBoard);
+  life::GameBoard exported = life::genBoard(256, 256);
+  int generation = 0;
+  for (const int steps : {1, 1, 2, 5, 8, 16, 31}) {
+    for (int i = 0; i < steps; i++) {
+      life::iterateBoard(gameBoard);
+    }
+    generation += steps;
+    hashLife.step(steps);
+    hashLife.exportBoard(exported);
+    ASSERT_EQ(gameBoard.board, exported.board) << "generation " << generation;
+    EXPECT_EQ(static_cast<std::uint64_t>(generation), hashLife.generation());
+  }
+}
+
+TEST(HashLifeTests, JumpsFarAhead) {
+  life::HashLife hashLife;
+  life::GameBoard gameBoard = life::genBoard(8, 8);
+  addGlider(gameBoard, 0, 0);
+  hashLife.importBoard(gameBoard);
+  // A glider moves one cell diagonally every four generations.
+  const std::uint64_t generations = std::uint64_t(1) << 40;
+  hashLife.step(generations);
+  EXPECT_EQ(generations, hashLife.generation());
+  EXPECT_EQ(5u, hashLife.population());
+  const std::int64_t shift = static_cast<std::int64_t>(generations / 4);
+  EXPECT_EQ(life::ALIVE, hashLife.getCellState(shift + 1, shift));
+  EXPECT_EQ(life::ALIVE, hashLife.getCellState(shift + 2, shift + 2));
+  EXPECT_EQ(life::DEAD, hashLife.getCellState(shift, shift));
+  EXPECT_GT(hashLife.cacheStats().hits, 0u);
+}
+
+TEST(HashLifeTests, HugeStepsKeepTheRootInRange) {
+  // A block is still and a blinker's period divides any power of two
+  // above 1, so only the generation count moves.
+  life::HashLife hashLife;
+  for (const auto &cell : {std::pair<int, int>{0, 0}, {1, 0}, {0, 1}, {1, 1},
+                           {10, 0}, {10, 1}, {10, 2}}) {
+    hashLife.setCellState(cell.first, cell.second, life::ALIVE);
+  }
+  const std::uint64_t generations = (std::uint64_t(1) << 63) |
+                                    (std::uint64_t(1) << 62);
+  hashLife.step(generations);
+  EXPECT_EQ(generations, hashLife.generation());
+  EXPECT_EQ(7u, hashLife.population());
+  EXPECT_EQ(life::ALIVE, hashLife.getCellState(1, 1));
+  EXPECT_EQ(life::ALIVE, hashLife.getCellState(10, 2));
+  EXPECT_EQ(life::DEAD, hashLife.getCellState(9, 1));
+}
+
+TEST(HashLifeTests, BoundedCacheEvicts) {
+  life::GameBoard gameBoard = randomBoard(64, 64, 5);
+  life::HashLife bounded(2000);
+  life::HashLife unbounded;
+  bounded.importBoard(gameBoard);
+  unbounded.importBoard(gameBoard);
+  bounded.step(300);
+  unbounded.step(300);
+  EXPECT_GT(bounded.cacheStats().evictions, 0u);
+  EXPECT_EQ(unbounded.population(), bounded.population());
+  for (int y = -200; y < 264; y += 3) {
+    for (int x = -200; x < 264; x += 3) {
+      ASSERT_EQ(unbounded.getCellState(x, y), bounded.getCellState(x, y));
+    }
+  }
+}
+
+TEST(HashLifeTests, SetCellStateGrowsUniverse) {
+  life::HashLife hashLife;
+  hashLife.setCellState(-1000, 5000, life::ALIVE);
+  hashLife.setCellState(3, 4, life::ALIVE);
+  EXPECT_EQ(2u, hashLife.population());
+  EXPECT_EQ(life::ALIVE, hashLife.getCellState(-1000, 5000));
+  hashLife.setCellState(-1000, 5000, life::DEAD);
+  EXPECT_EQ(1u, hashLife.population());
+}
+
+TEST(SparseBoardTests, GetSetCellState) {
+  life::SparseBoard board = life::genSparseBoard();
+  life::setCellState(board, -1, -1, life::ALIVE);
+  life::setCellState(board, 0, 0, life::ALIVE);
+  life::setCellState(board, 1000000, -5000000, life::ALIVE);
+  EXPECT_EQ(life::ALIVE, life::getCellState(board, -1, -1));
+  EXPECT_EQ(life::ALIVE, life::getCellState(board, 1000000, -5000000));
+  EXPECT_EQ(life::DEAD, life::getCellState(board, -1, 0));
+  EXPECT_EQ(2, life::neighborCount(board, -1, 0));
+  EXPECT_EQ(3u, life::population(board));
+  EXPECT_EQ(3u, board.tiles.size());
+  // Emptying a tile frees it.
+  life::setCellState(board, 1000000, -5000000, life::DEAD);
+  EXPECT_EQ(2u, board.tiles.size());
+}
+
+TEST(SparseBoardTests, CellsBeyondThePlaneStayDead) {
+  const std::int64_t edge = life::SPARSE_PLANE_TILES * life::SPARSE_TILE_SIZE;
+  life::SparseBoard board = life::genSparseBoard();
+  // 2^32 tiles out would share the origin's tile key.
+  life::setCellState(board, 5 + (edge << 1), 5, life::ALIVE);
+  life::setCellState(board, 5, -edge - 1, life::ALIVE);
+  EXPECT_EQ(life::DEAD, life::getCellState(board, 5, 5));
+  EXPECT_EQ(life::DEAD, life::getCellState(board, 5 + (edge << 1), 5));
+  EXPECT_EQ(0u, life::population(board));
+
+  // A blinker on the last column turns across the edge and loses the
+  // cell beyond it rather than wrapping to the far side.
+  for (int y = 0; y < 3; y++) {
+    life::setCellState(board, edge - 1, y, life::ALIVE);
+  }
+  life::iterateBoard(board);
+  EXPECT_EQ(2u, life::population(board));
+  EXPECT_EQ(life::ALIVE, life::getCellState(board, edge - 2, 1));
+  EXPECT_EQ(life::ALIVE, life::getCellState(board, edge - 1, 1));
+  EXPECT_EQ(life::DEAD, life::getCellState(board, -edge, 1));
+}
+
+TEST(SparseBoardTests, IterateBoardMatchesGameBoardAwayFromEdges) {
+  // Soup in the middle of a board, straddling tile boundaries, stepped
+  // until just before anything could reach the board's edge.
+  life::GameBoard soup = randomBoard(40, 40, 17);
+  life::GameBoard gameBoard = life::genBoard(300, 300);
+  for (std::size_t i = 0; i < soup.aliveList.size(); i++) {
+    life::setCellState(gameBoard, 110 + soup.aliveList.x[i],
+                       110 + soup.aliveList.y[i], life::ALIVE);
+  }
+  life::SparseBoard board = life::toSparseBoard(gameBoard);
+  for (int generation = 0; generation < 100; generation++) {
+    life::iterateBoard(gameBoard);
+    life::iterateBoard(board);
+    ASSERT_EQ(gameBoard.board, life::toGameBoard(board, 0, 0, 300, 300).board)
+        << "generation " << generation;
+  }
+}
+
+TEST(SparseBoardTests, GliderLeavesAnyFixedBox) {
+  life::SparseBoard board = life::genSparseBoard();
+  // Glider heading south-east, started across negative coordinates.
+  life::setCellState(board, -2, -3, life::ALIVE);
+  life::setCellState(board, -1, -2, life::ALIVE);
+  life::setCellState(board, -3, -1, life::ALIVE);
+  life::setCellState(board, -2, -1, life::ALIVE);
+  life::setCellState(board, -1, -1, life::ALIVE);
+  for (int generation = 0; generation < 4 * 1000; generation++) {
+    life::iterateBoard(board);
+  }
+  EXPECT_EQ(5u, life::population(board));
+  EXPECT_LE(board.tiles.size(), 4u);
+  EXPECT_EQ(life::ALIVE, life::getCellState(board, 998, 997));
+  EXPECT_EQ(life::ALIVE, life::getCellState(board, 999, 998));
+  EXPECT_EQ(life::ALIVE, life::getCellState(board, 997, 999));
+  EXPECT_EQ(life::ALIVE, life::getCellState(board, 998, 999));
+  EXPECT_EQ(life::ALIVE, life::getCellState(board, 999, 999));
+}
+
+TEST(TripleBufferTests, ReaderSeesOnlyTheNewestValue) {
+  life::TripleBuffer<int> buffer;
+  EXPECT_FALSE(buffer.update());
+  buffer.back() = 1;
+  buffer.publish();
+  buffer.back() = 2;
+  buffer.publish();
+  EXPECT_TRUE(buffer.update());
+  EXPECT_EQ(2, buffer.front());
+  EXPECT_FALSE(buffer.update());
+  EXPECT_EQ(2, buffer.front());
+  buffer.back() = 3;
+  buffer.publish();
+  EXPECT_TRUE(buffer.update());
+  EXPECT_EQ(3, buffer.front());
+}
+
+TEST(TripleBufferTests, ConcurrentReaderNeverSeesTornValues) {
+  // Every published value is a run of one repeated number; a torn read
+  // would mix two.
+  life::TripleBuffer<std::vector<int>> buffer;
+  constexpr int values = 20000;
+  std::thread writer([&] {
+    for (int value = 1; value <= values; value++) {
+      buffer.back().assign(64, value);
+      buffer.publish();
+    }
+  });
+  int last = 0;
+  while (last < values) {
+    if (!buffer.update()) {
+      continue;
+    }
+    const std::vector<int> &front = buffer.front();
+    ASSERT_EQ(64u, front.size());
+    ASSERT_GT(front[0], last);
+    ASSERT_EQ(std::count(front.begin(), front.end(), front[0]), 64);
+    last = front[0];
+  }
+  writer.join();
+}
+
+// Polls until the simulation has published a frame matching done.
+template <typename Done>
+static life::Frame &waitForFrame(life::Simulation &simulation, Done done) {
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (true) {
+    life::Frame &frame = simulation.latestFrame();
+    if (done(frame) || std::chrono::steady_clock::now() > deadline) {
+      return frame;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+TEST(SimulationTests, FramesMatchSerialStepping) {
+  life::ThreadPool pool(2);
+  const life::GameBoard initial = randomBoard(60, 80, 5);
+  life::Simulation simulation(initial, &pool);
+  EXPECT_EQ(0u, simulation.latestFrame().generation);
+  EXPECT_EQ(initial.board, simulation.latestFrame().board.board);
+  simulation.start();
+  waitForFrame(simulation,
+               [](const life::Frame &frame) { return frame.generation >= 25; });
+  simulation.stop();
+
+  const life::Frame &frame = simulation.latestFrame();
+  life::GameBoard expected = initial;
+  for (std::uint64_t generation = 0; generation < frame.generation;
+       generation++) {
+    life::iterateBoard(expected);
+  }
+  EXPECT_EQ(expected.board, frame.board.board);
+  EXPECT_EQ(expected.aliveList.x, frame.board.aliveList.x);
+  EXPECT_EQ(expected.aliveList.y, frame.board.aliveList.y);
+}
+
+TEST(SimulationTests, CommandsRunBetweenGenerations) {
+  life::Simulation simulation(life::genBoard(20, 20));
+  simulation.setPaused(true);
+  simulation.start();
+  // A blinker posted as three edits arrives in one frame while paused.
+  simulation.post([](life::GameBoard &board) {
+    life::setCellState(board, 5, 4, life::ALIVE);
+    life::setCellState(board, 5, 5, life::ALIVE);
+    life::setCellState(board, 5, 6, life::ALIVE);
+  });
+  life::Frame &edited = waitForFrame(simulation, [](const life::Frame &frame) {
+    return frame.board.aliveList.size() == 3;
+  });
+  EXPECT_EQ(3u, edited.board.aliveList.size());
+  EXPECT_EQ(0u, edited.generation);
+  EXPECT_TRUE(simulation.isPaused());
+
+  simulation.setTargetRate(1000);
+  simulation.setPaused(false);
+  life::Frame &stepped = waitForFrame(
+      simulation, [](const life::Frame &frame) { return frame.generation >= 3; });
+  simulation.stop();
+  EXPECT_GE(stepped.generation, 3u);
+  // The blinker is vertical on even generations, horizontal on odd ones.
+  const bool vertical = stepped.generation % 2 == 0;
+  EXPECT_EQ(life::ALIVE, life::getCellState(stepped.board, 5, 5));
+  EXPECT_EQ(vertical ? life::ALIVE : life::DEAD,
+            life::getCellState(stepped.board, 5, 4));
+  EXPECT_EQ(vertical ? life::DEAD : life::ALIVE,
+            life::getCellState(stepped.board, 4, 5));
+  EXPECT_EQ(3u, stepped.board.aliveList.size());
+}
+
+TEST(SimulationTests, SkippedFramesMarkChangesFull) {
+  // A glider changes few enough cells that only skipping sets full.
+  life::GameBoard gameBoard = life::genBoard(30, 30);
+  addGlider(gameBoard, 2, 2);
+  life::Simulation simulation(gameBoard);
+  simulation.post(
+      [](life::GameBoard &board) { life::trackChanges(board, true); });
+  simulation.start();
+  life::Frame &first = waitForFrame(
+      simulation, [](const life::Frame &frame) { return frame.generation >= 1; });
+  const std::uint64_t sequence = first.sequence;
+  life::clearChanges(first.board);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  simulation.stop();
+  life::Frame &later = simulation.latestFrame();
+  ASSERT_GT(later.sequence, sequence + 1);
+  EXPECT_TRUE(later.board.changes.full);
+}
+
+TEST(SnapshotTests, RebuildMatchesSetCellState) {
+  const life::GameBoard expected = randomBoard(37, 70, 11);
+  life::GameBoard rebuilt = life::genBoard(37, 70);
+  for (std::size_t i = 0; i < expected.board.size(); i++) {
+    rebuilt.board[i] = expected.board[i] & life::ALIVE;
+  }
+  life::rebuildBoard(rebuilt);
+  EXPECT_EQ(expected.board, rebuilt.board);
+  EXPECT_EQ(sortedByRow(expected.aliveList), sortedByRow(rebuilt.aliveList));
+  life::iterateBoard(rebuilt);
+  EXPECT_EQ(referenceIterate(expected).board, rebuilt.board);
+}
+
+TEST(SnapshotTests, RoundTripsInBothEncodings) {
+  // Widths either side of a word boundary exercise the row padding.
+  for (const int width : {1, 63, 64, 65, 130}) {
+    for (const auto encoding :
+         {life::SnapshotEncoding::BITS, life::SnapshotEncoding::RUNS}) {
+      life::GameBoard gameBoard = randomBoard(29, width, width);
+      life::setRule(gameBoard, *life::parseRule("B36/S23"));
+      const std::string path = testing::TempDir() + "round_trip.snapshot";
+      ASSERT_TRUE(life::saveSnapshot(
+          path, life::captureSnapshot(gameBoard, 1234 + width), encoding));
+      const auto loaded = life::loadSnapshot(path);
+      ASSERT_TRUE(loaded.has_value()) << "width " << width;
+      EXPECT_EQ(encoding, loaded->encoding);
+      EXPECT_EQ(1234u + width, loaded->generation);
+      EXPECT_EQ(gameBoard.rule.birth, loaded->board.rule.birth);
+      EXPECT_EQ(gameBoard.rule.survive, loaded->board.rule.survive);
+      EXPECT_EQ(gameBoard.height, loaded->board.height);
+      EXPECT_EQ(gameBoard.width, loaded->board.width);
+      EXPECT_EQ(gameBoard.board, loaded->board.board);
+      EXPECT_EQ(sortedByRow(gameBoard.aliveList),
+                sortedByRow(loaded->board.aliveList));
+    }
+  }
+}
+
+TEST(SnapshotTests, RunsAreSmallForSparseBoards) {
+  life::GameBoard gameBoard = life::genBoard(500, 500);
+  addGlider(gameBoard, 100, 100);
+  const life::Snapshot snapshot = life::captureSnapshot(gameBoard, 0);
+  const std::string bits = testing::TempDir() + "sparse_bits.snapshot";
+  const std::string runs = testing::TempDir() + "sparse_runs.snapshot";
+  ASSERT_TRUE(life::saveSnapshot(bits, snapshot, life::SnapshotEncoding::BITS));
+  ASSERT_TRUE(life::saveSnapshot(runs, snapshot, life::SnapshotEncoding::RUNS));
+  const auto size = [](const std::string &path) {
+    return std::ifstream(path, std::ios::binary | std::ios::ate).tellg();
+  };
+  EXPECT_LT(size(runs), 100);
+  EXPECT_GT(size(bits), 500 * 8 * 8);
+}
+
+TEST(SnapshotTests, RejectsBadFiles) {
+  const std::string path = testing::TempDir() + "bad.snapshot";
+  EXPECT_FALSE(life::loadSnapshot(path + ".missing").has_value());
+
+  const life::GameBoard gameBoard = randomBoard(20, 20, 3);
+  ASSERT_TRUE(life::saveSnapshot(path, life::captureSnapshot(gameBoard, 0)));
+  std::string contents;
+  {
+    std::ifstream in(path, std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(in), {});
+  }
+  const auto write = [&](const std::string &bytes) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << bytes;
+  };
+  write(contents.substr(0, contents.size() - 1));
+  EXPECT_FALSE(life::loadSnapshot(path).has_value());
+  write(contents.substr(0, 20));
+  EXPECT_FALSE(life::loadSnapshot(path).has_value());
+  std::string badMagic = contents;
+  badMagic[0] = 'X';
+  write(badMagic);
+  EXPECT_FALSE(life::loadSnapshot(path).has_value());
+  write(contents);
+  EXPECT_TRUE(life::loadSnapshot(path).has_value());
+}
+
+TEST(SnapshotTests, SavesInTheBackground) {
+  const life::GameBoard gameBoard = randomBoard(64, 64, 8);
+  const std::string path = testing::TempDir() + "async.snapshot";
+  auto saved = life::saveSnapshotAsync(path, life::captureSnapshot(gameBoard, 7),
+                                       life::SnapshotEncoding::RUNS);
+  ASSERT_TRUE(saved.get());
+  const auto loaded = life::loadSnapshot(path);
+  ASSERT_TRUE(loaded.has_value());
+  EXPECT_EQ(7u, loaded->generation);
+  EXPECT_EQ(gameBoard.board, loaded->board.board);
+}
+
+TEST(SimulationTests, RestoreReplacesBoardAndGeneration) {
+  life::Simulation simulation(randomBoard(30, 30, 2));
+  simulation.setPaused(true);
+  simulation.start();
+  life::GameBoard replacement = life::genBoard(12, 17);
+  addGlider(replacement, 3, 3);
+  simulation.restore(replacement, 500);
+  life::Frame &restored = waitForFrame(
+      simulation, [](const life::Frame &frame) { return frame.generation == 500; });
+  simulation.stop();
+  EXPECT_EQ(500u, restored.generation);
+  EXPECT_EQ(17, restored.board.width);
+  EXPECT_EQ(replacement.board, restored.board.board);
+  EXPECT_TRUE(restored.board.changes.full);
+}
+
+static std::optional<life::PatternInfo>
+readText(const std::string &text, life::PatternFormat format,
+         life::GameBoard &gameBoard, int x = 0, int y = 0) {
+  std::istringstream in(text);
+  return life::readPattern(in, format, gameBoard, x, y);
+}
+
+static const life::CellList GLIDER = {{1, 0}, {2, 1}, {0, 2}, {1, 2}, {2, 2}};
+
+TEST(PatternTests, ReadsRle) {
+  life::GameBoard gameBoard = life::genBoard(10, 10);
+  const auto info = readText("#N Glider\n#C comment\nx = 3, y = 3, rule = B36/S23\n"
+                             "bo$2bo$\n3o!\n",
+                             life::PatternFormat::RLE, gameBoard, 4, 5);
+  ASSERT_TRUE(info.has_value());
+  EXPECT_EQ(3, info->width);
+  EXPECT_EQ(3, info->height);
+  EXPECT_EQ(life::HIGHLIFE, gameBoard.rule);
+  life::CellList expected;
+  for (const auto &cell : GLIDER) {
+    expected.emplace_back(cell.first + 4, cell.second + 5);
+  }
+  EXPECT_EQ(sortedByRow(expected), sortedByRow(gameBoard.aliveList));
+  EXPECT_EQ(1, life::neighborCount(gameBoard, 4, 5));
+}
+
+TEST(PatternTests, ReadsSurvivalFirstRulesAndPlaintext) {
+  life::GameBoard rle = life::genBoard(10, 10);
+  ASSERT_TRUE(readText("x = 1, y = 1, rule = 23/36\no!", life::PatternFormat::RLE,
+                       rle));
+  EXPECT_EQ(life::HIGHLIFE, rle.rule);
+
+  life::GameBoard cells = life::genBoard(10, 10);
+  ASSERT_TRUE(readText("!Name: Glider\n.O\n..O\r\nOOO\n", life::PatternFormat::CELLS,
+                       cells));
+  EXPECT_EQ(sortedByRow(GLIDER), sortedByRow(cells.aliveList));
+}
+
+TEST(PatternTests, ReadsMacrocell) {
+  const std::string text = "[M2] (golly 4.0)\n#R B3/S23\n#G 42\n"
+                           ".*$..*$***$\n4 1 0 0 0\n5 0 2 0 0\n";
+  life::GameBoard gameBoard = life::genBoard(40, 40);
+  const auto info = readText(text, life::PatternFormat::MACROCELL, gameBoard);
+  ASSERT_TRUE(info.has_value());
+  EXPECT_EQ(32, info->width);
+  EXPECT_EQ(42u, info->generation);
+  life::CellList expected;
+  for (const auto &cell : GLIDER) {
+    expected.emplace_back(cell.first + 16, cell.second);
+  }
+  EXPECT_EQ(sortedByRow(expected), sortedByRow(gameBoard.aliveList));
+
+  // Cells beyond a smaller board are clipped.
+  life::GameBoard small = life::genBoard(8, 18);
+  ASSERT_TRUE(readText(text, life::PatternFormat::MACROCELL, small));
+  EXPECT_EQ(3u, small.aliveList.size());
+}
+
+TEST(PatternTests, RejectsMalformedText) {
+  life::GameBoard gameBoard = life::genBoard(10, 10);
+  EXPECT_FALSE(readText("x = 3, y = 3\n3q!", life::PatternFormat::RLE, gameBoard));
+  EXPECT_FALSE(readText("x = 3, y = 3, rule = B9/S\no!", life::PatternFormat::RLE,
+                        gameBoard));
+  EXPECT_FALSE(readText(".O\n.X\n", life::PatternFormat::CELLS, gameBoard));
+  EXPECT_FALSE(readText("not a macrocell\n", life::PatternFormat::MACROCELL,
+                        gameBoard));
+  // A child must already be defined and one level down.
+  EXPECT_FALSE(readText("[M2]\n4 2 0 0 0\n", life::PatternFormat::MACROCELL,
+                        gameBoard));
+  EXPECT_FALSE(readText("[M2]\n.*$\n5 1 0 0 0\n", life::PatternFormat::MACROCELL,
+                        gameBoard));
+  // The board stays consistent after a partial read.
+  EXPECT_EQ(gameBoard.aliveList.size(),
+            static_cast<std::size_t>(std::count_if(
+                gameBoard.board.begin(), gameBoard.board.end(),
+                [](char cell) { return cell & life::ALIVE; })));
+}
+
+TEST(PatternTests, RoundTripsEveryFormat) {
+  for (const auto format : {life::PatternFormat::RLE, life::PatternFormat::CELLS,
+                            life::PatternFormat::MACROCELL}) {
+    // Large enough that the text spans several read buffers.
+    life::GameBoard gameBoard = randomBoard(300, 310, 17);
+    life::setCellState(gameBoard, 0, 0, life::DEAD);
+    std::ostringstream out;
+    ASSERT_TRUE(life::writePattern(out, format, gameBoard, 9));
+    const std::string text = out.str();
+
+    int minX = gameBoard.width, minY = gameBoard.height;
+    for (std::size_t i = 0; i < gameBoard.aliveList.size(); i++) {
+      minX = std::min(minX, gameBoard.aliveList.x[i]);
+      minY = std::min(minY, gameBoard.aliveList.y[i]);
+    }
+    life::GameBoard loaded = life::genBoard(300, 310);
+    const auto info = readText(text, format, loaded, minX, minY);
+    ASSERT_TRUE(info.has_value()) << static_cast<int>(format);
+    EXPECT_EQ(gameBoard.board, loaded.board) << static_cast<int>(format);
+    EXPECT_EQ(sortedByRow(gameBoard.aliveList), sortedByRow(loaded.aliveList));
+    if (format == life::PatternFormat::RLE) {
+      std::istringstream lines(text);
+      std::string line;
+      while (std::getline(lines, line)) {
+        EXPECT_LE(line.size(), 70u) << line;
+      }
+    }
+    if (format == life::PatternFormat::MACROCELL) {
+      EXPECT_EQ(9u, info->generation);
+    }
+  }
+}
+
+TEST(PatternTests, ReadsIntoSparseBoard) {
+  life::SparseBoard board = life::genSparseBoard();
+  std::istringstream in("x = 3, y = 3\nbo$2bo$3o!");
+  ASSERT_TRUE(life::readPattern(in, life::PatternFormat::RLE, board, -100, -200));
+  EXPECT_EQ(5u, life::population(board));
+  for (const auto &cell : GLIDER) {
+    EXPECT_EQ(life::ALIVE,
+              life::getCellState(board, cell.first - 100, cell.second - 200));
+  }
+}
+
+TEST(PatternTests, SavesAndLoadsFilesByExtension) {
+  life::GameBoard gameBoard = life::genBoard(20, 20);
+  addGlider(gameBoard, 2, 3);
+  life::setRule(gameBoard, life::HIGHLIFE);
+  const std::string path = testing::TempDir() + "glider.rle";
+  ASSERT_TRUE(life::savePattern(path, gameBoard));
+  EXPECT_FALSE(life::savePattern(testing::TempDir() + "glider.txt", gameBoard));
+
+  // Loading centres a pattern that declares its size.
+  life::GameBoard loaded = life::genBoard(21, 21);
+  const auto info = life::loadPattern(path, loaded);
+  ASSERT_TRUE(info.has_value());
+  EXPECT_EQ(life::HIGHLIFE, loaded.rule);
+  EXPECT_EQ(5u, loaded.aliveList.size());
+  EXPECT_EQ(life::ALIVE, life::getCellState(loaded, 10, 11));
+  EXPECT_EQ(life::DEAD, life::getCellState(loaded, 10, 10));
+}
+
+TEST(SeedBoardTests, SameSeedSameBoardOnAnyThreadCount) {
+  const int sizes[][2] = {{1, 1}, {37, 130}, {200, 64}};
+  for (const auto &size : sizes) {
+    life::GameBoard serial = life::genBoard(size[0], size[1]);
+    life::seedBoard(serial, 0.37, 99);
+    for (const int threads : {2, 3, 8}) {
+      life::ThreadPool pool(threads);
+      life::GameBoard parallel = life::genBoard(size[0], size[1]);
+      life::seedBoard(parallel, 0.37, 99, pool);
+      ASSERT_EQ(serial.board, parallel.board) << threads;
+      ASSERT_EQ(serial.aliveList, parallel.aliveList) << threads;
+    }
+  }
+}
+
+TEST(SeedBoardTests, CountsMatchSetCellState) {
+  life::GameBoard seeded = life::genBoard(45, 101);
+  life::setCellState(seeded, 3, 3, life::ALIVE);
+  life::seedBoard(seeded, 0.5, 7);
+  life::GameBoard expected = life::genBoard(45, 101);
+  for (std::size_t i = 0; i < seeded.aliveList.size(); i++) {
+    life::setCellState(expected, seeded.aliveList.x[i], seeded.aliveList.y[i],
+                       life::ALIVE);
+  }
+  EXPECT_EQ(expected.board, seeded.board);
+  EXPECT_EQ(sortedByRow(expected.aliveList), sortedByRow(seeded.aliveList));
+  const int firstX = seeded.aliveList.x[0];
+  const int firstY = seeded.aliveList.y[0];
+  life::setCellState(seeded, firstX, firstY, life::DEAD);
+  life::setCellState(expected, firstX, firstY, life::DEAD);
+  EXPECT_EQ(sortedByRow(expected.aliveList), sortedByRow(seeded.aliveList));
+  life::iterateBoard(seeded);
+  life::iterateBoard(expected);
+  EXPECT_EQ(expected.board, seeded.board);
+}
+
+TEST(SeedBoardTests, DensityAndSeedShapeTheBoard) {
+  life::GameBoard gameBoard = life::genBoard(256, 256);
+  life::seedBoard(gameBoard, 0.0, 1);
+  EXPECT_TRUE(gameBoard.aliveList.empty());
+  life::seedBoard(gameBoard, 1.0, 1);
+  EXPECT_EQ(gameBoard.board.size(), gameBoard.aliveList.size());
+  for (const double density : {0.1, 0.3, 0.5, 0.9}) {
+    life::seedBoard(gameBoard, density, 1);
+    const double fraction =
+        static_cast<double>(gameBoard.aliveList.size()) / gameBoard.board.size();
+    EXPECT_NEAR(density, fraction, 0.01) << density;
+  }
+  const life::Board first = gameBoard.board;
+  life::seedBoard(gameBoard, 0.9, 2);
+  EXPECT_NE(first, gameBoard.board);
+}
+
+TEST(SetCellStatesTests, MatchesSetCellStateWriteByWrite) {
+  std::mt19937 rng(4);
+  for (const int count : {3, 40, 300, 2000}) {
+    life::GameBoard batched = randomBoard(41, 77, count);
+    life::trackChanges(batched, true);
+    life::clearChanges(batched);
+    life::GameBoard single = batched;
+    std::uniform_int_distribution<int> x(-2, 78);
+    std::uniform_int_distribution<int> y(-2, 42);
+    std::vector<life::CellWrite> writes;
+    for (int i = 0; i < count; i++) {
+      writes.push_back({x(rng), y(rng), static_cast<char>(rng() % 2)});
+    }
+    // Repeated cells must end in their last written state.
+    writes.push_back(writes.front());
+    writes.push_back({writes.front().x, writes.front().y,
+                      static_cast<char>(!writes.front().state)});
+
+    life::setCellStates(batched, writes);
+    for (const life::CellWrite &write : writes) {
+      if (write.x >= 0 && write.y >= 0 && write.x < 77 && write.y < 41) {
+        life::setCellState(single, write.x, write.y, write.state);
+      }
+    }
+    ASSERT_EQ(single.board, batched.board) << count;
+    EXPECT_EQ(single.aliveList, batched.aliveList);
+    EXPECT_EQ(single.changes.births, batched.changes.births);
+    EXPECT_EQ(single.changes.deaths, batched.changes.deaths);
+    life::iterateBoardSparse(single);
+    life::iterateBoardSparse(batched);
+    EXPECT_EQ(single.board, batched.board);
+  }
+}
+
+TEST(SetCellStatesTests, EditsAtTheEdges) {
+  life::GameBoard batched = life::genBoard(9, 9);
+  life::GameBoard single = life::genBoard(9, 9);
+  std::vector<life::CellWrite> writes;
+  for (int i = 0; i < 9; i++) {
+    writes.push_back({i, 0, life::ALIVE});
+    writes.push_back({8, i, life::ALIVE});
+    writes.push_back({0, 8 - i, life::ALIVE});
+  }
+  life::setCellStates(batched, writes);
+  for (const life::CellWrite &write : writes) {
+    life::setCellState(single, write.x, write.y, write.state);
+  }
+  EXPECT_EQ(single.board, batched.board);
+}
+
+// Reference stepping that finds every neighbour across the boundary by
+// modular arithmetic and reads only the alive bits.
+static life::GameBoard boundaryReference(const life::GameBoard &gameBoard) {
+  const int height = gameBoard.height;
+  const int width = gameBoard.width;
+  life::GameBoard next = life::genBoard(height, width, gameBoard.boundary);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      int count = 0;
+      for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+          if (dx == 0 && dy == 0) {
+            continue;
+          }
+          int nx = x + dx;
+          int ny = y + dy;
+          if (ny < 0 || ny >= height) {
+            if (gameBoard.boundary == life::Boundary::DEAD) {
+              continue;
+            }
+            ny = (ny + height) % height;
+            if (gameBoard.boundary == life::Boundary::KLEIN) {
+              nx = width - 1 - nx;
+            }
+          }
+          if (nx < 0 || nx >= width) {
+            if (gameBoard.boundary == life::Boundary::DEAD) {
+              continue;
+            }
+            nx = (nx + width) % width;
+          }
+          count += life::getCellState(gameBoard, nx, ny);
+        }
+      }
+      const bool alive = life::getCellState(gameBoard, x, y) == life::ALIVE;
+      if (count == 3 || (count == 2 && alive)) {
+        life::setCellState(next, x, y, life::ALIVE);
+      }
+    }
+  }
+  return next;
+}
+
+TEST(BoundaryTests, EveryKernelMatchesReference) {
+  life::ThreadPool pool(3);
+  const int sizes[][2] = {{1, 1}, {2, 5}, {3, 3}, {37, 70}, {64, 64}};
+  for (const auto boundary : {life::Boundary::DEAD, life::Boundary::TORUS,
+                              life::Boundary::KLEIN}) {
+    for (const auto &size : sizes) {
+      life::GameBoard serial = randomBoard(size[0], size[1], size[0] + size[1]);
+      life::setBoundary(serial, boundary);
+      life::GameBoard parallel = serial;
+      life::GameBoard sparse = serial;
+      for (int generation = 0; generation < 30; generation++) {
+        const life::GameBoard expected = boundaryReference(serial);
+        life::iterateBoard(serial);
+        life::iterateBoard(parallel, pool);
+        life::iterateBoardSparse(sparse);
+        ASSERT_EQ(expected.board, serial.board)
+            << static_cast<int>(boundary) << " " << size[0] << "x" << size[1]
+            << " generation " << generation;
+        ASSERT_EQ(expected.aliveList, serial.aliveList);
+        ASSERT_EQ(expected.board, parallel.board);
+        ASSERT_EQ(expected.aliveList, parallel.aliveList);
+        ASSERT_EQ(expected.board, sparse.board);
+      }
+    }
+  }
+}
+
+TEST(BoundaryTests, GliderCirclesTheTorus) {
+  life::GameBoard torus = life::genBoard(16, 16, life::Boundary::TORUS);
+  addGlider(torus, 6, 6);
+  const life::Board start = torus.board;
+  // A glider moves one cell diagonally every four generations.
+  for (int generation = 0; generation < 4 * 16; generation++) {
+    life::iterateBoardSparse(torus);
+    ASSERT_EQ(5u, torus.aliveList.size()) << generation;
+  }
+  EXPECT_EQ(start, torus.board);
+}
+
+TEST(BoundaryTests, SetCellStatesMatchesSetCellStateAcrossEdges) {
+  std::mt19937 rng(20);
+  for (const auto boundary : {life::Boundary::TORUS, life::Boundary::KLEIN}) {
+    // A cluster in a corner, a wide scatter, and enough for a full recount.
+    for (const int count : {40, 300, 2000}) {
+      life::GameBoard batched = life::genBoard(41, 77, boundary);
+      life::GameBoard single = batched;
+      std::uniform_int_distribution<int> x(0, count == 40 ? 5 : 76);
+      std::uniform_int_distribution<int> y(0, count == 40 ? 5 : 40);
+      std::vector<life::CellWrite> writes;
+      for (int i = 0; i < count; i++) {
+        writes.push_back({x(rng), y(rng), static_cast<char>(rng() % 2)});
+      }
+      life::setCellStates(batched, writes);
+      for (const life::CellWrite &write : writes) {
+        life::setCellState(single, write.x, write.y, write.state);
+      }
+      ASSERT_EQ(single.board, batched.board)
+          << static_cast<int>(boundary) << " " << count;
+      const life::GameBoard expected = boundaryReference(single);
+      life::iterateBoard(batched);
+      EXPECT_EQ(expected.board, batched.board);
+    }
+  }
+}
+
+TEST(BoundaryTests, SeedingAndSnapshotsKeepTheBoundary) {
+  life::GameBoard gameBoard = life::genBoard(33, 65, life::Boundary::KLEIN);
+  life::seedBoard(gameBoard, 0.4, 8);
+  life::GameBoard expected = life::genBoard(33, 65, life::Boundary::KLEIN);
+  for (int y = 0; y < 33; y++) {
+    for (int x = 0; x < 65; x++) {
+      life::setCellState(expected, x, y, life::getCellState(gameBoard, x, y));
+    }
+  }
+  ASSERT_EQ(expected.board, gameBoard.board);
+
+  const std::string path = testing::TempDir() + "boundary.snapshot";
+  ASSERT_TRUE(life::saveSnapshot(path, life::captureSnapshot(gameBoard, 0)));
+  const auto loaded = life::loadSnapshot(path);
+  ASSERT_TRUE(loaded.has_value());
+  EXPECT_EQ(life::Boundary::KLEIN, loaded->board.boundary);
+  EXPECT_EQ(gameBoard.board, loaded->board.board);
+}
+
+TEST(BoundaryTests, ParseBoundary) {
+  EXPECT_EQ(life::Boundary::DEAD, life::parseBoundary("dead"));
+  EXPECT_EQ(life::Boundary::TORUS, life::parseBoundary("torus"));
+  EXPECT_EQ(life::Boundary::KLEIN, life::parseBoundary("klein"));
+  EXPECT_FALSE(life::parseBoundary("Torus").has_value());
+  EXPECT_FALSE(life::parseBoundary("").has_value());
+}
+
+TEST(WorkStealingPoolTests, RunsEveryTaskOnce) {
+  for (const int threads : {1, 2, 4}) {
+    life::WorkStealingPool pool(threads);
+    EXPECT_EQ(threads, pool.size());
+    std::vector<std::atomic<int>> hits(97);
+    for (int round = 0; round < 20; round++) {
+      // The first few tasks are slow, so the other threads must steal them
+      // from the first thread's share.
+      pool.run(static_cast<int>(hits.size()), [&](int i) {
+        if (i < 4) {
+          std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        hits[i]++;
+      });
+    }
+    for (auto &hit : hits) {
+      EXPECT_EQ(20, hit.load());
+    }
+  }
+}
+
+TEST(BatchTests, ParseJobsExpandsLists) {
+  std::istringstream in("# a sweep\n"
+                        "\n"
+                        "size=64,32x16 density=0.25,0.5 rule=B36/S23\n"
+                        "seed=7 generations=100 period=0 boundary=torus\n");
+  const auto jobs = life::parseJobs(in);
+  ASSERT_TRUE(jobs.has_value());
+  ASSERT_EQ(5u, jobs->size());
+  EXPECT_EQ(64, (*jobs)[0].width);
+  EXPECT_EQ(64, (*jobs)[0].height);
+  EXPECT_EQ(0.25, (*jobs)[0].density);
+  EXPECT_EQ(0.5, (*jobs)[1].density);
+  EXPECT_EQ(32, (*jobs)[2].width);
+  EXPECT_EQ(16, (*jobs)[2].height);
+  EXPECT_EQ(life::HIGHLIFE, (*jobs)[3].rule);
+  const life::BatchJob &last = (*jobs)[4];
+  EXPECT_EQ(7u, last.seed);
+  EXPECT_EQ(100u, last.generations);
+  EXPECT_EQ(0, last.maxPeriod);
+  EXPECT_EQ(life::Boundary::TORUS, last.boundary);
+  EXPECT_EQ(life::CONWAY, last.rule);
+}
+
+TEST(BatchTests, ParseJobsRejectsMalformedLines) {
+  for (const char *text : {"size=0", "size=10x", "density=1.5", "rule=B3",
+                           "colour=red", "seed", "seed=-1", "period=",
+                           "size=65536x65536"}) {
+    std::istringstream in(std::string("size=8\n") + text + "\n");
+    int line = 0;
+    EXPECT_FALSE(life::parseJobs(in, &line).has_value()) << text;
+    EXPECT_EQ(2, line) << text;
+  }
+}
+
+TEST(BatchTests, RunBoardStopsAtTheFirstRepeat) {
+  life::GameBoard blinker = life::genBoard(8, 8);
+  life::setCellState(blinker, 2, 3, life::ALIVE);
+  life::setCellState(blinker, 3, 3, life::ALIVE);
+  life::setCellState(blinker, 4, 3, life::ALIVE);
+  life::BatchResult result = life::runBoard(blinker, 1000, 8);
+  EXPECT_EQ(2, result.period);
+  EXPECT_EQ(2u, result.generations);
+  EXPECT_EQ(3u, result.population);
+
+  // A glider on a torus comes back where it started after 4 * side.
+  life::GameBoard torus = life::genBoard(8, 8, life::Boundary::TORUS);
+  addGlider(torus, 2, 2);
+  result = life::runBoard(torus, 1000, 32);
+  EXPECT_EQ(32, result.period);
+  EXPECT_EQ(32u, result.generations);
+  EXPECT_EQ(5u, result.population);
+
+  // Too short a limit, or no period search, runs to the limit.
+  torus = life::genBoard(8, 8, life::Boundary::TORUS);
+  addGlider(torus, 2, 2);
+  EXPECT_EQ(0, life::runBoard(torus, 1000, 31).period);
+  EXPECT_EQ(0, life::runBoard(blinker, 50, 0).period);
+  EXPECT_EQ(50u, life::runBoard(blinker, 50, 0).generations);
+}
+
+TEST(BatchTests, RunJobIsRepeatable) {
+  life::BatchJob job;
+  job.width = 48;
+  job.height = 40;
+  job.density = 0.35;
+  job.seed = 3;
+  job.generations = 2000;
+  const life::BatchResult first = life::runJob(job);
+  const life::BatchResult second = life::runJob(job);
+  EXPECT_EQ(first.generations, second.generations);
+  EXPECT_EQ(first.population, second.population);
+  EXPECT_EQ(first.period, second.period);
+
+  std::ostringstream out;
+  life::writeResultHeader(out);
+  life::writeResult(out, 4, job, first);
+  const std::string text = out.str();
+  EXPECT_EQ(0u, text.find("job,width,height,rule,boundary,density,seed,"));
+  EXPECT_NE(std::string::npos, text.find("\n4,48,40,B3/S23,dead,0.35,3,"));
+}
+
+TEST(HashTests, EveryWriteAndStepKeepsTheHash) {
+  life::ThreadPool pool(3);
+  for (const auto boundary : {life::Boundary::DEAD, life::Boundary::TORUS}) {
+    life::GameBoard serial = randomBoard(37, 70, 22);
+    life::setBoundary(serial, boundary);
+    life::trackHash(serial, true);
+    ASSERT_EQ(life::boardHash(serial), serial.hash);
+    life::GameBoard parallel = serial;
+    life::GameBoard sparse = serial;
+    for (int generation = 0; generation < 20; generation++) {
+      life::iterateBoard(serial);
+      life::iterateBoard(parallel, pool);
+      life::iterateBoardSparse(sparse);
+      ASSERT_EQ(life::boardHash(serial), serial.hash) << generation;
+      ASSERT_EQ(serial.hash, parallel.hash) << generation;
+      ASSERT_EQ(serial.hash, sparse.hash) << generation;
+    }
+
+    std::mt19937 rng(9);
+    std::vector<life::CellWrite> writes;
+    for (int i = 0; i < 500; i++) {
+      writes.push_back({static_cast<int>(rng() % 70),
+                        static_cast<int>(rng() % 37),
+                        static_cast<char>(rng() % 2)});
+    }
+    life::setCellStates(serial, writes);
+    EXPECT_EQ(life::boardHash(serial), serial.hash);
+    life::setCellState(serial, 0, 0, !life::getCellState(serial, 0, 0));
+    EXPECT_EQ(life::boardHash(serial), serial.hash);
+    life::seedBoard(serial, 0.3, 5);
+    EXPECT_EQ(life::boardHash(serial), serial.hash);
+    life::seedBoard(serial, 0.3, 6, pool);
+    EXPECT_EQ(life::boardHash(serial), serial.hash);
+  }
+}
+
+TEST(HashTests, RepeatedStatesHashAlike) {
+  life::GameBoard gameBoard = life::genBoard(12, 12);
+  life::trackHash(gameBoard, true);
+  EXPECT_EQ(0u, gameBoard.hash);
+  life::setCellState(gameBoard, 4, 5, life::ALIVE);
+  life::setCellState(gameBoard, 5, 5, life::ALIVE);
+  life::setCellState(gameBoard, 6, 5, life::ALIVE);
+  const std::uint64_t horizontal = gameBoard.hash;
+  life::iterateBoard(gameBoard);
+  EXPECT_NE(horizontal, gameBoard.hash);
+  life::iterateBoard(gameBoard);
+  EXPECT_EQ(horizontal, gameBoard.hash);
+
+  // Without hashing the steps leave it alone.
+  life::trackHash(gameBoard, false);
+  life::iterateBoard(gameBoard);
+  EXPECT_EQ(horizontal, gameBoard.hash);
+}
+
+TEST(CycleDetectorTests, FindsTheShortestPeriod) {
+  life::CycleDetector cycles(4);
+  EXPECT_EQ(0, cycles.record(1));
+  EXPECT_EQ(0, cycles.record(2));
+  EXPECT_EQ(0, cycles.record(3));
+  EXPECT_EQ(3, cycles.record(1));
+  EXPECT_EQ(3, cycles.record(2));
+  EXPECT_EQ(1, cycles.record(2));
+  EXPECT_EQ(1, cycles.period());
+
+  // Past maxPeriod a repeat is forgotten.
+  cycles.reset();
+  EXPECT_EQ(0u, cycles.size());
+  for (const std::uint64_t hash : {10, 11, 12, 13, 14}) {
+    EXPECT_EQ(0, cycles.record(hash));
+  }
+  EXPECT_EQ(0, cycles.record(10));
+  EXPECT_EQ(3, cycles.record(13));
+
+  life::CycleDetector off(0);
+  EXPECT_EQ(0, off.record(1));
+  EXPECT_EQ(0, off.record(1));
+}
+
+// A blinker at (3, 3) and, far from it, a pre-block that settles in one step.
+static life::GameBoard blinkerAndPreBlock() {
+  life::GameBoard gameBoard = life::genBoard(20, 20);
+  life::setCellState(gameBoard, 3, 2, life::ALIVE);
+  life::setCellState(gameBoard, 3, 3, life::ALIVE);
+  life::setCellState(gameBoard, 3, 4, life::ALIVE);
+  life::setCellState(gameBoard, 14, 14, life::ALIVE);
+  life::setCellState(gameBoard, 15, 14, life::ALIVE);
+  life::setCellState(gameBoard, 14, 15, life::ALIVE);
+  return gameBoard;
+}
+
+static void clearBlinker(life::GameBoard &board) {
+  for (int i = 2; i <= 4; i++) {
+    life::setCellState(board, 3, i, life::DEAD);
+    life::setCellState(board, i, 3, life::DEAD);
+  }
+}
+
+TEST(SimulationTests, StillLifeKeepsCountingGenerations) {
+  life::Simulation simulation(blinkerAndPreBlock());
+  simulation.detectCycles(8);
+  simulation.setTargetRate(20000);
+  simulation.start();
+  waitForFrame(simulation,
+               [](const life::Frame &frame) { return frame.generation >= 10; });
+  EXPECT_EQ(2, simulation.cyclePeriod());
+
+  // Without the blinker the board is a still life, which goes on counting
+  // generations without changing or publishing new frames.
+  simulation.post(clearBlinker);
+  std::uint64_t settled = 0;
+  std::uint64_t sequence = 0;
+  waitForFrame(simulation, [&](const life::Frame &frame) {
+    if (settled == 0 && simulation.cyclePeriod() == 1) {
+      settled = frame.generation;
+      sequence = frame.sequence;
+    }
+    return settled != 0 && frame.generation >= settled + 1000;
+  });
+  simulation.stop();
+  EXPECT_EQ(1, simulation.cyclePeriod());
+  const life::Frame &frame = simulation.latestFrame();
+  EXPECT_GE(frame.generation, settled + 1000);
+  EXPECT_EQ(sequence, frame.sequence);
+  EXPECT_EQ(4u, frame.board.aliveList.size());
+}
+
+TEST(SimulationTests, SettledBoardSleepsAtUnlimitedRate) {
+  life::Simulation simulation(blinkerAndPreBlock());
+  simulation.detectCycles(8);
+  simulation.start();
+  simulation.post(clearBlinker);
+  waitForFrame(simulation, [&](const life::Frame &) {
+    return simulation.cyclePeriod() == 1;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  const std::uint64_t generation = simulation.generation();
+  const std::uint64_t sequence = simulation.latestFrame().sequence;
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(generation, simulation.generation());
+  EXPECT_EQ(sequence, simulation.latestFrame().sequence);
+  EXPECT_EQ(generation, simulation.latestFrame().generation);
+
+  // An edit wakes it: the new blinker is published and stepped.
+  simulation.post([](life::GameBoard &board) {
+    for (int i = 2; i <= 4; i++) {
+      life::setCellState(board, 3, i, life::ALIVE);
+    }
+  });
+  const life::Frame &frame = waitForFrame(
+      simulation, [&](const life::Frame &frame) {
+        return frame.generation >= generation + 10;
+      });
+  EXPECT_GE(frame.generation, generation + 10);
+  EXPECT_GT(frame.sequence, sequence);
+  simulation.stop();
+}
+
+TEST(ShardTests, SeedRowMatchesSeedBoard) {
+  life::GameBoard gameBoard = life::genBoard(5, 150);
+  life::seedBoard(gameBoard, 0.3, 77);
+  std::vector<char> row(150);
+  for (int y = 0; y < 5; y++) {
+    life::seedRow(row.data(), 150, y, 37, 131, 0.3, 77);
+    for (int x = 37; x < 131; x++) {
+      ASSERT_EQ(life::getCellState(gameBoard, x, y), row[x - 37]) << x << "," << y;
+    }
+  }
+}
+
+TEST(ShardTests, NeighboursWrapOnlyOnATorus) {
+  life::ShardLayout layout;
+  layout.columns = 3;
+  layout.rows = 2;
+  EXPECT_EQ(-1, life::shardNeighbour(layout, 0, -1, 0));
+  EXPECT_EQ(4, life::shardNeighbour(layout, 0, 1, 1));
+  EXPECT_EQ(-1, life::shardNeighbour(layout, 5, 1, 0));
+  layout.boundary = life::Boundary::TORUS;
+  EXPECT_EQ(2, life::shardNeighbour(layout, 0, -1, 0));
+  EXPECT_EQ(5, life::shardNeighbour(layout, 0, -1, -1));
+  EXPECT_EQ(3, life::shardNeighbour(layout, 5, 1, 0));
+  EXPECT_TRUE(life::validLayout(layout));
+  layout.boundary = life::Boundary::KLEIN;
+  EXPECT_FALSE(life::validLayout(layout));
+  layout.boundary = life::Boundary::DEAD;
+  layout.columns = layout.width + 1;
+  EXPECT_FALSE(life::validLayout(layout));
+}
+
+TEST(ShardTests, ShardsOnThreadsMatchIterateBoard) {
+  struct Case {
+    int width;
+    int height;
+    int columns;
+    int rows;
+    life::Boundary boundary;
+    life::Rule rule;
+  };
+  for (const Case &test : {Case{60, 45, 3, 2, life::Boundary::DEAD, life::CONWAY},
+                           Case{61, 40, 2, 3, life::Boundary::TORUS, life::CONWAY},
+                           Case{37, 29, 1, 1, life::Boundary::TORUS, life::HIGHLIFE},
+                           Case{12, 30, 4, 1, life::Boundary::TORUS, life::CONWAY},
+                           Case{50, 50, 2, 2, life::Boundary::DEAD, life::DAY_AND_NIGHT}}) {
+    life::ShardLayout layout;
+    layout.width = test.width;
+    layout.height = test.height;
+    layout.columns = test.columns;
+    layout.rows = test.rows;
+    layout.boundary = test.boundary;
+    layout.rule = test.rule;
+    ASSERT_TRUE(life::validLayout(layout));
+    auto transports = life::connectLocal(layout.shards());
+    ASSERT_TRUE(transports);
+    std::vector<std::unique_ptr<life::Shard>> shards;
+    for (int i = 0; i < layout.shards(); i++) {
+      shards.push_back(
+          std::make_unique<life::Shard>(layout, i, (*transports)[i]));
+      shards.back()->seed(0.35, 8);
+    }
+
+    life::GameBoard gameBoard =
+        life::genBoard(test.height, test.width, test.boundary);
+    life::setRule(gameBoard, test.rule);
+    life::seedBoard(gameBoard, 0.35, 8);
+    for (int generation = 0; generation < 25; generation++) {
+      life::iterateBoard(gameBoard);
+    }
+
+    std::vector<std::thread> threads;
+    std::vector<char> stepped(layout.shards(), 0);
+    for (int i = 0; i < layout.shards(); i++) {
+      threads.emplace_back([&, i] {
+        bool ok = true;
+        for (int generation = 0; generation < 25 && ok; generation++) {
+          ok = shards[i]->step();
+        }
+        stepped[i] = ok;
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    for (int i = 0; i < layout.shards(); i++) {
+      ASSERT_TRUE(stepped[i]);
+      EXPECT_EQ(25u, shards[i]->generation());
+    }
+    std::size_t population = 0;
+    for (const auto &shard : shards) {
+      population += shard->population();
+    }
+    EXPECT_EQ(gameBoard.aliveList.size(), population);
+    for (const auto &shard : shards) {
+      for (int y = shard->top(); y < shard->top() + shard->tileHeight(); y++) {
+        for (int x = shard->left(); x < shard->left() + shard->tileWidth();
+             x++) {
+          ASSERT_EQ(life::getCellState(gameBoard, x, y),
+                    shard->getCellState(x, y))
+              << x << "," << y;
+        }
+      }
+    }
+  }
+}
+
+TEST(ShardTests, StepFailsWhenANeighbourIsGone) {
+  life::ShardLayout layout;
+  layout.width = 20;
+  layout.height = 10;
+  layout.columns = 2;
+  auto transports = life::connectLocal(2);
+  ASSERT_TRUE(transports);
+  life::Shard shard(layout, 0, (*transports)[0]);
+  shard.setCellState(9, 4, life::ALIVE);
+  (*transports)[1] = life::SocketTransport();
+  EXPECT_FALSE(shard.step());
+  EXPECT_EQ(0u, shard.generation());
+  EXPECT_EQ(life::ALIVE, shard.getCellState(9, 4));
+}
+
+TEST(ArenaTests, TilePoolRecyclesAlignedBlocks) {
+  for (const bool hugePages : {false, true}) {
+    life::TilePool pool(100, hugePages);
+    EXPECT_EQ(128u, pool.size());
+    std::vector<void *> blocks;
+    for (int i = 0; i < 5000; i++) {
+      blocks.push_back(pool.allocate());
+      ASSERT_EQ(0u, reinterpret_cast<std::uintptr_t>(blocks.back()) %
+                        life::CACHE_LINE);
+      std::memset(blocks.back(), i, pool.size());
+    }
+    std::sort(blocks.begin(), blocks.end());
+    EXPECT_EQ(blocks.end(), std::adjacent_find(blocks.begin(), blocks.end()));
+    EXPECT_EQ(5000u * 128, pool.stats().inUse);
+    EXPECT_GE(pool.stats().reserved, pool.stats().inUse);
+
+    const std::size_t reserved = pool.stats().reserved;
+    for (void *block : blocks) {
+      pool.release(block);
+    }
+    EXPECT_EQ(0u, pool.stats().inUse);
+    for (int i = 0; i < 5000; i++) {
+      pool.allocate();
+    }
+    EXPECT_EQ(reserved, pool.stats().reserved);
+    EXPECT_EQ(5000u * 128, pool.stats().highWater);
+  }
+}
+
+TEST(ArenaTests, ScratchArenaSettlesIntoOneChunk) {
+  life::ScratchArena scratch(1024);
+  for (int round = 0; round < 3; round++) {
+    for (int i = 0; i < 3; i++) {
+      char *bytes = scratch.allocate<char>(1000);
+      ASSERT_EQ(0u, reinterpret_cast<std::uintptr_t>(bytes) % life::CACHE_LINE);
+      std::memset(bytes, i, 1000);
+    }
+    EXPECT_EQ(3000u, scratch.stats().inUse);
+    scratch.reset();
+    EXPECT_EQ(0u, scratch.stats().inUse);
+  }
+  // The first round spilled over three chunks; since then one holds it.
+  EXPECT_EQ(3072u, scratch.stats().reserved);
+  EXPECT_EQ(3000u, scratch.stats().highWater);
+}
+
+TEST(SparseBoardTests, TilesComeFromTheBoardsPool) {
+  life::SparseBoard board = life::genSparseBoard();
+  life::setCellState(board, 1, 0, life::ALIVE);
+  life::setCellState(board, 2, 1, life::ALIVE);
+  life::setCellState(board, 0, 2, life::ALIVE);
+  life::setCellState(board, 1, 2, life::ALIVE);
+  life::setCellState(board, 2, 2, life::ALIVE);
+  std::size_t reserved = 0;
+  for (int generation = 0; generation < 1000; generation++) {
+    life::iterateBoard(board);
+    EXPECT_EQ(board.tiles.size() * sizeof(life::SparseTile),
+              board.pool.stats().inUse);
+    if (generation == 100) {
+      reserved = board.pool.stats().reserved;
+    }
+  }
+  // The glider crosses many tiles, always reusing the same few blocks.
+  EXPECT_EQ(reserved, board.pool.stats().reserved);
+  EXPECT_EQ(5u, life::population(board));
+
+  life::SparseBoard copy = board;
+  life::setCellState(copy, 1000, 1000, life::ALIVE);
+  EXPECT_EQ(6u, life::population(copy));
+  EXPECT_EQ(5u, life::population(board));
+  board = copy;
+  EXPECT_EQ(life::ALIVE, life::getCellState(board, 1000, 1000));
+}
+
+TEST(TiledBoardTests, TilesAreInMortonOrder) {
+  life::TiledBoard board = life::genTiledBoard(256, 256);
+  ASSERT_EQ(16u, board.order.size());
+  // (0, 0), (1, 0), (0, 1), (1, 1), then the next 2x2 block.
+  EXPECT_EQ(0, board.order[0]);
+  EXPECT_EQ(1, board.order[1]);
+  EXPECT_EQ(4, board.order[2]);
+  EXPECT_EQ(5, board.order[3]);
+  EXPECT_EQ(2, board.order[4]);
+  for (int tile = 0; tile < 16; tile++) {
+    EXPECT_EQ(tile, board.order[board.slot[tile]]);
+  }
+
+  // A wide board is not padded out to a square.
+  life::TiledBoard wide = life::genTiledBoard(64, 16384);
+  EXPECT_EQ(16384u * 64, wide.cells.size());
+}
+
+TEST(TiledBoardTests, GetSetCellStateAcrossTileEdges) {
+  life::TiledBoard board = life::genTiledBoard(100, 130);
+  life::GameBoard gameBoard = life::genBoard(100, 130);
+  for (const auto &cell : std::vector<std::pair<int, int>>{
+           {63, 63}, {64, 63}, {63, 64}, {64, 64}, {0, 0}, {129, 99},
+           {128, 64}, {10, 10}, {127, 0}}) {
+    life::setCellState(board, cell.first, cell.second, life::ALIVE);
+    life::setCellState(gameBoard, cell.first, cell.second, life::ALIVE);
+  }
+  life::setCellState(board, 64, 64, life::DEAD);
+  life::setCellState(gameBoard, 64, 64, life::DEAD);
+  for (int y = 0; y < 100; y++) {
+    for (int x = 0; x < 130; x++) {
+      ASSERT_EQ(life::getCellState(gameBoard, x, y),
+                life::getCellState(board, x, y));
+      ASSERT_EQ(life::neighborCount(gameBoard, x, y),
+                life::neighborCount(board, x, y))
+          << x << "," << y;
+    }
+  }
+  EXPECT_EQ(8u, life::population(board));
+}
+
+TEST(TiledBoardTests, IterateBoardMatchesGameBoard) {
+  life::ThreadPool pool(3);
+  for (const auto &size : std::vector<std::pair<int, int>>{
+           {64, 64}, {100, 130}, {70, 200}, {1, 1}, {300, 65}}) {
+    for (const life::Rule &rule : {life::CONWAY, life::HIGHLIFE,
+                                   life::DAY_AND_NIGHT, *life::parseRule("B0/S8")}) {
+      life::GameBoard gameBoard =
+          randomBoard(size.first, size.second, size.first + size.second);
+      life::setRule(gameBoard, rule);
+      life::TiledBoard serial = life::toTiledBoard(gameBoard);
+      life::TiledBoard parallel = serial;
+      for (int generation = 0; generation < 20; generation++) {
+        life::iterateBoard(gameBoard);
+        life::iterateBoard(serial);
+        life::iterateBoard(parallel, pool);
+      }
+      EXPECT_EQ(gameBoard.aliveList.size(), life::population(serial));
+      ASSERT_EQ(serial.cells, parallel.cells);
+      const life::GameBoard back = life::toGameBoard(serial);
+      ASSERT_EQ(gameBoard.board, back.board)
+          << size.first << "x" << size.second << " " << life::ruleString(rule);
+    }
+  }
+}
+
+TEST(TiledBoardTests, GliderCrossesQuietTiles) {
+  life::GameBoard gameBoard = life::genBoard(200, 260);
+  life::setCellState(gameBoard, 61, 60, life::ALIVE);
+  life::setCellState(gameBoard, 62, 61, life::ALIVE);
+  life::setCellState(gameBoard, 60, 62, life::ALIVE);
+  life::setCellState(gameBoard, 61, 62, life::ALIVE);
+  life::setCellState(gameBoard, 62, 62, life::ALIVE);
+  life::TiledBoard board = life::toTiledBoard(gameBoard);
+  for (int generation = 0; generation < 400; generation++) {
+    life::iterateBoard(gameBoard);
+    life::iterateBoard(board);
+  }
+  EXPECT_EQ(5u, life::population(board));
+  EXPECT_EQ(gameBoard.board, life::toGameBoard(board).board);
+}
+
 // Main function to run all tests
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,239 @@
+// life_shard.cpp
+//
+// Steps one board split across processes, a shard per tile, which swap
+// their halos over socketpairs each generation, e.g.
+//
+//   life_shard --size 8192x8192 --grid 4x2 --generations 1000
+//
+// forks eight processes each stepping a 2048x4096 tile. Each shard reports
+// only its population, so no process ever holds the whole board. The board
+// is seeded as seedBoard seeds it, so --check can gather the tiles here,
+// step the same seed with iterateBoard and compare the result cell for
+// cell; that needs the board to fit in this process twice.
+#include "Shard.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+bool parsePair(const char *text, int &first, int &second) {
+  char x;
+  char rest;
+  return std::sscanf(text, "%d%c%d%c", &first, &x, &second, &rest) == 3 &&
+         x == 'x';
+}
+
+bool readAll(const int fd, char *data, std::size_t size) {
+  while (size > 0) {
+    const ssize_t count = read(fd, data, size);
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count <= 0) {
+      return false;
+    }
+    data += count;
+    size -= static_cast<std::size_t>(count);
+  }
+  return true;
+}
+
+bool writeAll(const int fd, const char *data, std::size_t size) {
+  while (size > 0) {
+    const ssize_t count = write(fd, data, size);
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count <= 0) {
+      return false;
+    }
+    data += count;
+    size -= static_cast<std::size_t>(count);
+  }
+  return true;
+}
+
+// The body of shard index's process: steps its tile and writes its
+// population to out, followed by the tile itself if gather is set.
+int runShard(const life::ShardLayout &layout, const int index,
+             life::SocketTransport transport, const double density,
+             const std::uint64_t seed, const std::uint64_t generations,
+             const bool gather, const int out) {
+  life::Shard shard(layout, index, transport);
+  shard.seed(density, seed);
+  for (std::uint64_t generation = 0; generation < generations; generation++) {
+    if (!shard.step()) {
+      return 1;
+    }
+  }
+  const std::uint64_t population = shard.population();
+  if (!writeAll(out, reinterpret_cast<const char *>(&population),
+                sizeof(population))) {
+    return 1;
+  }
+  if (!gather) {
+    return 0;
+  }
+  const std::vector<char> tile = shard.tile();
+  return writeAll(out, tile.data(), tile.size()) ? 0 : 1;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  life::ShardLayout layout;
+  layout.width = 1024;
+  layout.height = 1024;
+  double density = 0.5;
+  std::uint64_t seed = 1;
+  std::uint64_t generations = 100;
+  bool check = false;
+  bool usage = false;
+  for (int i = 1; i < argc && !usage; i++) {
+    const bool hasValue = i + 1 < argc;
+    if (std::strcmp(argv[i], "--size") == 0 && hasValue) {
+      usage = !parsePair(argv[++i], layout.width, layout.height);
+    } else if (std::strcmp(argv[i], "--grid") == 0 && hasValue) {
+      usage = !parsePair(argv[++i], layout.columns, layout.rows);
+    } else if (std::strcmp(argv[i], "--rule") == 0 && hasValue) {
+      const auto rule = life::parseRule(argv[++i]);
+      usage = !rule;
+      layout.rule = rule.value_or(life::CONWAY);
+    } else if (std::strcmp(argv[i], "--boundary") == 0 && hasValue) {
+      const auto boundary = life::parseBoundary(argv[++i]);
+      usage = !boundary;
+      layout.boundary = boundary.value_or(life::Boundary::DEAD);
+    } else if (std::strcmp(argv[i], "--density") == 0 && hasValue) {
+      density = std::atof(argv[++i]);
+    } else if (std::strcmp(argv[i], "--seed") == 0 && hasValue) {
+      seed = std::strtoull(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "--generations") == 0 && hasValue) {
+      generations = std::strtoull(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "--check") == 0) {
+      check = true;
+    } else {
+      usage = true;
+    }
+  }
+  if (usage || layout.width < 1 || layout.height < 1 ||
+      !life::validLayout(layout)) {
+    std::cerr << "usage: life_shard [--size WxH] [--grid CxR] [--rule R]\n"
+                 "                  [--boundary dead|torus] [--density D]\n"
+                 "                  [--seed S] [--generations N] [--check]"
+              << std::endl;
+    return 2;
+  }
+
+  auto transports = life::connectLocal(layout.shards());
+  if (!transports) {
+    std::cerr << "Could not connect the shards" << std::endl;
+    return 1;
+  }
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<int> results(layout.shards(), -1);
+  std::vector<pid_t> children;
+  for (int i = 0; i < layout.shards(); i++) {
+    int pipeEnds[2];
+    if (pipe(pipeEnds) != 0) {
+      std::cerr << "Could not make a pipe" << std::endl;
+      return 1;
+    }
+    const pid_t child = fork();
+    if (child == 0) {
+      close(pipeEnds[0]);
+      life::SocketTransport transport = std::move((*transports)[i]);
+      transports.reset();
+      _exit(runShard(layout, i, std::move(transport), density, seed,
+                     generations, check, pipeEnds[1]));
+    }
+    close(pipeEnds[1]);
+    if (child < 0) {
+      close(pipeEnds[0]);
+      std::cerr << "Could not fork shard " << i << std::endl;
+      return 1;
+    }
+    children.push_back(child);
+    results[i] = pipeEnds[0];
+  }
+  // Only the shards hold their sockets, so a shard that dies fails its
+  // neighbours' steps rather than leaving them waiting.
+  transports.reset();
+
+  // The whole board comes back only for --check.
+  std::vector<char> cells;
+  if (check) {
+    cells.resize(static_cast<std::size_t>(layout.width) * layout.height);
+  }
+  std::vector<std::uint64_t> populations(layout.shards(), 0);
+  bool complete = true;
+  for (int i = 0; i < layout.shards(); i++) {
+    complete = complete &&
+               readAll(results[i], reinterpret_cast<char *>(&populations[i]),
+                       sizeof(populations[i]));
+    if (!check) {
+      close(results[i]);
+      continue;
+    }
+    const int column = i % layout.columns;
+    const int row = i / layout.columns;
+    const int x0 = layout.columnStart(column);
+    const int width = layout.columnStart(column + 1) - x0;
+    for (int y = layout.rowStart(row); y < layout.rowStart(row + 1); y++) {
+      complete = complete &&
+                 readAll(results[i],
+                         cells.data() + static_cast<std::size_t>(y) *
+                                            layout.width +
+                             x0,
+                         width);
+    }
+    close(results[i]);
+  }
+  for (const pid_t child : children) {
+    int status = 0;
+    waitpid(child, &status, 0);
+    complete = complete && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+  }
+  if (!complete) {
+    std::cerr << "A shard failed" << std::endl;
+    return 1;
+  }
+  const double seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+  std::uint64_t population = 0;
+  for (int i = 0; i < layout.shards(); i++) {
+    std::cout << "shard " << i << ": population " << populations[i]
+              << std::endl;
+    population += populations[i];
+  }
+  std::cout << layout.shards() << " shards, " << generations
+            << " generations in " << seconds << " s ("
+            << generations / seconds << " gens/sec), population "
+            << population << std::endl;
+
+  if (check) {
+    life::GameBoard board =
+        life::genBoard(layout.height, layout.width, layout.boundary);
+    life::setRule(board, layout.rule);
+    life::seedBoard(board, density, seed);
+    for (std::uint64_t generation = 0; generation < generations;
+         generation++) {
+      life::iterateBoard(board);
+    }
+    for (std::size_t i = 0; i < cells.size(); i++) {
+      if ((board.board[i] & life::ALIVE) != cells[i]) {
+        std::cerr << "Differs from iterateBoard at (" << i % layout.width
+                  << ", " << i / layout.width << ")" << std::endl;
+        return 1;
+      }
+    }
+    std::cout << "Matches iterateBoard" << std::endl;
+  }
+  return 0;
+}
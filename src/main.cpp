@@ -3,20 +3,48 @@
 #include "SDL3/SDL.h"
 #include "SDL3/SDL_main.h"
 
+#include "Renderer.hpp"
+#include "Simulation.hpp"
 #include "Stats.hpp"
+#include "Telemetry.hpp"
+#include "ThreadPool.hpp"
 #include "life.hpp"
+#include "pattern.hpp"
+#include "snapshot.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <vector>
 
 #define WINDOW_WIDTH 1000
 #define WINDOW_HEIGHT 1000
 
 #define INITIAL_BOARD_WIDTH 500
 #define INITIAL_BOARD_HEIGHT 500
-life::GameBoard gameBoard;
+// Threads used to step the board, 0 for one per core, 1 to step serially.
+// Overridden with --threads N.
+#define SIMULATION_THREADS 0
+// Generations per second the simulation thread aims for, 0 for as fast as
+// it can. Overridden with --rate N.
+#define SIMULATION_RATE 60
+// Longest oscillator period the simulation watches for; a board that has
+// settled into a still life is no longer stepped. 0 turns the watch off.
+// Overridden with --max-period N.
+#define MAX_PERIOD 64
+// Where 'p' saves the board and 'l' loads it from. Overridden with
+// --snapshot PATH.
+#define SNAPSHOT_PATH "life.snapshot"
 
 typedef struct {
   SDL_Window *window{};
   SDL_Renderer *renderer{};
   life::Stats appStats{};
+  life::StatId renderTimer = appStats.registerTimer(life::RENDER);
+  life::StatId presentTimer = appStats.registerTimer(life::PRESENT);
   Uint64 lastTime = 0;
 
   struct Mouse {
@@ -29,12 +57,46 @@ typedef struct {
 
   Mouse mouse;
   bool simulationPaused = false;
+  // Mouse edits since the last frame, posted to the simulation as one batch.
+  std::vector<life::CellWrite> pendingEdits;
   int boardWidth = INITIAL_BOARD_WIDTH;
   int boardHeight = INITIAL_BOARD_HEIGHT;
   bool vsyncState = true;
-  bool renderAliveList = true;
+  int simulationThreads = SIMULATION_THREADS;
+  double simulationRate = SIMULATION_RATE;
+  int maxPeriod = MAX_PERIOD;
+  life::Rule rule = life::CONWAY;
+  // Set with --boundary dead|torus|klein.
+  life::Boundary boundary = life::Boundary::DEAD;
+  std::unique_ptr<life::ThreadPool> threadPool;
+  std::unique_ptr<life::Renderer> boardRenderer;
+  // Owns the board; declared after threadPool so it stops first.
+  std::unique_ptr<life::Simulation> simulation;
+  // Set with --telemetry PATH and --telemetry-interval SECONDS.
+  const char *telemetryPath = nullptr;
+  double telemetryInterval = 1.0;
+  std::ofstream telemetryFile;
+  std::unique_ptr<life::Telemetry> telemetry;
+  const char *snapshotPath = SNAPSHOT_PATH;
+  // Set with --pattern PATH: an .rle, .cells or .mc file to start from.
+  const char *patternPath = nullptr;
+  // Set by 'p'; the next frame is captured and saved in the background.
+  bool snapshotRequested = false;
+  std::future<bool> snapshotSave;
 } AppState;
 
+// The diff backend patches from the board's change list, which costs a diff
+// pass per step, so only keep it while that backend is selected.
+bool wantsChanges(AppState *appState) {
+  return appState->boardRenderer->backend() == life::RenderBackend::DIFF;
+}
+
+void syncChangeTracking(AppState *appState) {
+  const bool track = wantsChanges(appState);
+  appState->simulation->post(
+      [track](life::GameBoard &board) { life::trackChanges(board, track); });
+}
+
 bool setVSync(AppState *appState) {
   if (appState->vsyncState && !SDL_SetRenderVSync(appState->renderer, 1)) {
     SDL_Log("Could not enable VSync: %s", SDL_GetError());
@@ -47,23 +109,26 @@ bool setVSync(AppState *appState) {
   return true;
 }
 
-void zapBoard(AppState *appState) {
-  // Init the board state with random cells
-  for (int y = 0; y < appState->boardHeight; y++) {
-    for (int x = 0; x < appState->boardWidth; x++) {
-      if (rand() % 2) {
-        life::setCellState(gameBoard, x, y, life::ALIVE);
-      }
-    }
+// Fills the board with random cells. Runs as a simulation command, so it
+// may use the simulation's pool.
+void zapBoard(life::GameBoard &gameBoard, life::ThreadPool *pool,
+              const std::uint64_t seed) {
+  if (pool != nullptr) {
+    life::seedBoard(gameBoard, 0.5, seed, *pool);
+  } else {
+    life::seedBoard(gameBoard, 0.5, seed);
   }
 }
 
-void stippleBoard(AppState *appState){
-  for (int y = 0; y < appState->boardWidth; y++) {
-    for (int x = 0; x < appState->boardHeight; x++) {
-      life::setCellState(gameBoard, x, y, ((x + (y % 2)) % 2 == 1)? life::ALIVE : life::DEAD);
+void stippleBoard(life::GameBoard &gameBoard){
+  std::vector<life::CellWrite> writes;
+  writes.reserve(gameBoard.board.size());
+  for (int y = 0; y < gameBoard.height; y++) {
+    for (int x = 0; x < gameBoard.width; x++) {
+      writes.push_back({x, y, ((x + (y % 2)) % 2 == 1) ? life::ALIVE : life::DEAD});
     }
   }
+  life::setCellStates(gameBoard, writes);
 }
 
 SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[]) {
@@ -87,8 +152,79 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[]) {
   }
 
   setVSync(appState);
+  appState->boardRenderer = std::make_unique<life::Renderer>(appState->renderer);
 
-  gameBoard = life::genBoard(appState->boardHeight, appState->boardWidth);
+  for (int i = 1; i + 1 < argc; i++) {
+    if (std::strcmp(argv[i], "--threads") == 0) {
+      appState->simulationThreads = std::atoi(argv[++i]);
+    } else if (std::strcmp(argv[i], "--rule") == 0) {
+      const auto rule = life::parseRule(argv[++i]);
+      if (!rule) {
+        SDL_Log("Could not parse rule: %s", argv[i]);
+        return SDL_APP_FAILURE;
+      }
+      appState->rule = *rule;
+    } else if (std::strcmp(argv[i], "--boundary") == 0) {
+      const auto boundary = life::parseBoundary(argv[++i]);
+      if (!boundary) {
+        SDL_Log("Could not parse boundary: %s", argv[i]);
+        return SDL_APP_FAILURE;
+      }
+      appState->boundary = *boundary;
+    } else if (std::strcmp(argv[i], "--max-period") == 0) {
+      appState->maxPeriod = std::atoi(argv[++i]);
+    } else if (std::strcmp(argv[i], "--rate") == 0) {
+      appState->simulationRate = std::atof(argv[++i]);
+    } else if (std::strcmp(argv[i], "--telemetry") == 0) {
+      appState->telemetryPath = argv[++i];
+    } else if (std::strcmp(argv[i], "--telemetry-interval") == 0) {
+      appState->telemetryInterval = std::atof(argv[++i]);
+    } else if (std::strcmp(argv[i], "--snapshot") == 0) {
+      appState->snapshotPath = argv[++i];
+    } else if (std::strcmp(argv[i], "--pattern") == 0) {
+      appState->patternPath = argv[++i];
+    }
+  }
+  if (appState->simulationThreads != 1) {
+    appState->threadPool =
+        std::make_unique<life::ThreadPool>(appState->simulationThreads);
+    SDL_Log("Stepping with %d threads", appState->threadPool->size());
+  }
+
+  life::GameBoard gameBoard =
+      life::genBoard(appState->boardHeight, appState->boardWidth,
+                     appState->boundary);
+  life::setRule(gameBoard, appState->rule);
+  if (appState->patternPath != nullptr) {
+    if (!life::loadPattern(appState->patternPath, gameBoard)) {
+      SDL_Log("Could not load pattern: %s", appState->patternPath);
+      return SDL_APP_FAILURE;
+    }
+    // A rule in the file wins over --rule.
+    appState->rule = gameBoard.rule;
+  }
+  life::trackChanges(gameBoard, wantsChanges(appState));
+  appState->simulation = std::make_unique<life::Simulation>(
+      std::move(gameBoard), appState->threadPool.get());
+  appState->simulation->setTargetRate(appState->simulationRate);
+  appState->simulation->recordSteps(appState->appStats);
+  appState->simulation->detectCycles(appState->maxPeriod);
+  appState->simulation->start();
+
+  if (appState->telemetryPath != nullptr) {
+    appState->telemetryFile.open(appState->telemetryPath);
+    if (!appState->telemetryFile) {
+      SDL_Log("Could not open telemetry file: %s", appState->telemetryPath);
+      return SDL_APP_FAILURE;
+    }
+    const auto interval = std::chrono::milliseconds(
+        static_cast<long long>(appState->telemetryInterval * 1000));
+    appState->telemetry = std::make_unique<life::Telemetry>(
+        appState->appStats, appState->telemetryFile,
+        life::telemetryFormatFor(appState->telemetryPath),
+        std::max(interval, std::chrono::milliseconds(1)));
+    appState->telemetry->start();
+  }
   appState->lastTime = SDL_GetTicks();
 
   SDL_Log("App initialized");
@@ -113,7 +249,18 @@ SDL_AppResult SDL_AppEvent(void *appstate, SDL_Event *event) {
       return SDL_APP_SUCCESS;
     }
     if (event->key.scancode == SDL_SCANCODE_A) {
-      appState->renderAliveList = !appState->renderAliveList;
+      auto &boardRenderer = *appState->boardRenderer;
+      boardRenderer.setBackend(life::nextRenderBackend(boardRenderer.backend()));
+      syncChangeTracking(appState);
+      std::cout << "Render backend: "
+                << life::renderBackendName(boardRenderer.backend())
+                << std::endl;
+    }
+    if (event->key.scancode == SDL_SCANCODE_T) {
+      auto &simulation = *appState->simulation;
+      simulation.setSparse(!simulation.isSparse());
+      std::cout << "Sparse stepping: "
+                << (simulation.isSparse() ? "on" : "off") << std::endl;
     }
     if (event->key.scancode == SDL_SCANCODE_V) {
       appState->vsyncState = !appState->vsyncState;
@@ -124,14 +271,47 @@ SDL_AppResult SDL_AppEvent(void *appstate, SDL_Event *event) {
                 << std::endl;
     }
     if (event->key.scancode == SDL_SCANCODE_Z) {
-      zapBoard(appState);
+      life::ThreadPool *pool = appState->threadPool.get();
+      const std::uint64_t seed = SDL_GetTicksNS();
+      appState->simulation->post([pool, seed](life::GameBoard &gameBoard) {
+        zapBoard(gameBoard, pool, seed);
+      });
     }
     if (event->key.scancode == SDL_SCANCODE_X) {
-      gameBoard = life::genBoard(appState->boardHeight, appState->boardWidth);
-      stippleBoard(appState);
+      const int height = appState->boardHeight;
+      const int width = appState->boardWidth;
+      const life::Rule rule = appState->rule;
+      const life::Boundary boundary = appState->boundary;
+      const bool track = wantsChanges(appState);
+      appState->simulation->post([=](life::GameBoard &gameBoard) {
+        gameBoard = life::genBoard(height, width, boundary);
+        life::setRule(gameBoard, rule);
+        life::trackChanges(gameBoard, track);
+        stippleBoard(gameBoard);
+      });
+    }
+    if (event->key.scancode == SDL_SCANCODE_P) {
+      appState->snapshotRequested = true;
     }
-    if (event->key.scancode == SDL_SCANCODE_SPACE)
+    if (event->key.scancode == SDL_SCANCODE_L) {
+      auto loaded = life::loadSnapshot(appState->snapshotPath);
+      if (!loaded) {
+        SDL_Log("Could not load snapshot: %s", appState->snapshotPath);
+      } else {
+        appState->boardHeight = loaded->board.height;
+        appState->boardWidth = loaded->board.width;
+        appState->rule = loaded->board.rule;
+        appState->boundary = loaded->board.boundary;
+        appState->simulation->restore(std::move(loaded->board),
+                                      loaded->generation);
+        std::cout << "Loaded snapshot at generation " << loaded->generation
+                  << std::endl;
+      }
+    }
+    if (event->key.scancode == SDL_SCANCODE_SPACE) {
       appState->simulationPaused = !appState->simulationPaused;
+      appState->simulation->setPaused(appState->simulationPaused);
+    }
   }
   if (event->type == SDL_EVENT_MOUSE_BUTTON_DOWN) {
     appState->mouse.down = true;
@@ -148,8 +328,8 @@ SDL_AppResult SDL_AppEvent(void *appstate, SDL_Event *event) {
     appState->mouse.y = event->button.y;
   }
 
-  int cellWidth = WINDOW_WIDTH / appState->boardWidth;
-  int cellHeight = WINDOW_HEIGHT / appState->boardHeight;
+  int cellWidth = std::max(1, WINDOW_WIDTH / appState->boardWidth);
+  int cellHeight = std::max(1, WINDOW_HEIGHT / appState->boardHeight);
 
   if (appState->mouse.down) {
     std::cout << "Mouse Button Down:" << std::endl;
@@ -157,81 +337,74 @@ SDL_AppResult SDL_AppEvent(void *appstate, SDL_Event *event) {
               << "clickY:" << appState->mouse.clickY << std::endl;
     std::cout << "x: " << appState->mouse.x << "y:" << appState->mouse.y
               << std::endl;
-    life::setCellState(gameBoard, appState->mouse.x / cellWidth,
-                       appState->mouse.y / cellHeight, life::ALIVE);
+    appState->pendingEdits.push_back({appState->mouse.x / cellWidth,
+                                      appState->mouse.y / cellHeight,
+                                      life::ALIVE});
   }
   return SDL_APP_CONTINUE;
 }
 
-/*
- window = x
- board = y
- window / board = # boards per window
- window |----------|
- board  |-----|
-  = 2 draws of window items for each board item
- b 0,0 = w 0,0
- b 1,0 = w 2,0
- b 1,1 = w 2,2
- */
-bool renderCell(SDL_Renderer *renderer, float cellSize, int x, int y) {
-  for (float xD = static_cast<float>(x); xD < x + cellSize; xD++) {
-    for (float yD = static_cast<float>(y); yD < y + cellSize; yD++) {
-      if (!SDL_RenderPoint(renderer, xD, yD)) {
-        SDL_Log("Could not render point: %s", SDL_GetError());
-        return false;
-      }
-    }
-  }
-  return true;
-}
-
 SDL_AppResult SDL_AppIterate(void *appstate) {
   static Uint64 ticks = 0;
   static Uint64 lastFrameRate = 0;
   auto *appState = static_cast<AppState *>(appstate);
   auto *appStats = &appState->appStats;
 
-  /* Progress the board forward one step. */
-  appStats->start(life::ITERATE, SDL_GetTicks());
-  if (!appState->simulationPaused) {
-    life::iterateBoard(gameBoard);
+  /* The simulation thread steps the board; pick up its newest frame. */
+  auto &simulation = *appState->simulation;
+  if (!appState->pendingEdits.empty()) {
+    // Applied between generations on the simulation thread.
+    simulation.post([edits = std::move(appState->pendingEdits)](
+                        life::GameBoard &gameBoard) {
+      life::setCellStates(gameBoard, edits);
+    });
+    appState->pendingEdits.clear();
+  }
+  life::Frame &frame = simulation.latestFrame();
+  appStats->set(life::GENERATION, frame.generation);
+  appStats->set(life::POPULATION, frame.board.aliveList.size());
+  appStats->set(life::PERIOD, simulation.cyclePeriod());
+  if (simulation.isSparse()) {
+    appStats->set(life::ACTIVE_TILES, simulation.lastActiveTiles());
   }
-  appStats->stop(life::ITERATE, SDL_GetTicks());
 
   // Render the board.
-  appStats->start(life::RENDER, SDL_GetTicks());
-  SDL_SetRenderDrawColor(appState->renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
-  SDL_RenderClear(appState->renderer);
-  SDL_SetRenderDrawColor(appState->renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
-  int cellWidth = WINDOW_WIDTH / appState->boardWidth;
-  int cellHeight = WINDOW_HEIGHT / appState->boardHeight;
-  if (appState->renderAliveList) {
-    for (auto &cell : gameBoard.aliveList) {
-      if (!renderCell(appState->renderer, cellWidth, cell.first * cellWidth,
-                      cell.second * cellWidth)) {
-        SDL_Log("Could not render point: %s", SDL_GetError());
-        return SDL_APP_FAILURE;
-      }
+  {
+    life::ScopedTimer renderTime(*appStats, appState->renderTimer);
+    SDL_SetRenderDrawColor(appState->renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
+    SDL_RenderClear(appState->renderer);
+    int cellWidth = std::max(1, WINDOW_WIDTH / frame.board.width);
+    if (!appState->boardRenderer->draw(frame.board, cellWidth)) {
+      SDL_Log("Could not render board: %s", SDL_GetError());
+      return SDL_APP_FAILURE;
     }
-  } else {
-    for (int y = 0; y < appState->boardHeight; y++) {
-      for (int x = 0; x < appState->boardWidth; x++) {
-        if (life::getCellState(gameBoard, x, y) == life::ALIVE) {
-          if (!renderCell(appState->renderer, cellWidth, x * cellWidth,
-                          y * cellWidth)) {
-            SDL_Log("Could not render point: %s", SDL_GetError());
-            return SDL_APP_FAILURE;
-          }
-        }
+    life::clearChanges(frame.board);
+  }
+
+  // Packing the bits is quick; the write runs on its own thread, so neither
+  // rendering nor the simulation waits on the disk.
+  if (appState->snapshotRequested) {
+    appState->snapshotRequested = false;
+    auto &pending = appState->snapshotSave;
+    if (pending.valid() && pending.wait_for(std::chrono::seconds(0)) !=
+                               std::future_status::ready) {
+      SDL_Log("Snapshot still saving, skipped");
+    } else {
+      if (pending.valid() && !pending.get()) {
+        SDL_Log("Could not save the previous snapshot");
       }
+      pending = life::saveSnapshotAsync(
+          appState->snapshotPath,
+          life::captureSnapshot(frame.board, frame.generation));
+      std::cout << "Saving snapshot at generation " << frame.generation
+                << std::endl;
     }
   }
-  appStats->stop(life::RENDER, SDL_GetTicks());
 
-  appStats->start(life::PRESENT, SDL_GetTicks());
-  SDL_RenderPresent(appState->renderer);
-  appStats->stop(life::PRESENT, SDL_GetTicks());
+  {
+    life::ScopedTimer presentTime(*appStats, appState->presentTimer);
+    SDL_RenderPresent(appState->renderer);
+  }
   Uint64 postframe = SDL_GetTicksNS();
   Uint64 rate = SDL_NS_PER_SECOND / (postframe - ticks);
   appStats->set(life::FRAMERATE, rate);
@@ -242,6 +415,12 @@ SDL_AppResult SDL_AppIterate(void *appstate) {
 void SDL_AppQuit(void *appstate, SDL_AppResult result) {
   if (appstate != nullptr) {
     auto *appState = static_cast<AppState *>(appstate);
+    appState->telemetry.reset();
+    if (appState->snapshotSave.valid()) {
+      appState->snapshotSave.wait();
+    }
+    appState->simulation.reset();
+    appState->boardRenderer.reset();
     SDL_DestroyRenderer(appState->renderer);
     SDL_DestroyWindow(appState->window);
     delete appState;
@@ -0,0 +1,816 @@
+// pattern.cpp
+#include "./pattern.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+
+namespace life {
+namespace {
+constexpr std::size_t BUFFER_SIZE = std::size_t(1) << 16;
+// Longest RLE body line written, as the format recommends.
+constexpr int RLE_LINE_LENGTH = 70;
+// Longest run count read; anything longer is taken as a corrupt file.
+constexpr std::int64_t MAX_RUN = std::int64_t(1) << 40;
+// Deepest macrocell node read, so coordinates fit in 64 bits.
+constexpr int MAX_LEVEL = 60;
+
+// Reads a stream through a fixed buffer, a character at a time.
+class Input {
+private:
+  std::istream &in;
+  std::vector<char> buffer;
+  std::size_t position = 0;
+  std::size_t end = 0;
+
+  bool fill() {
+    in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    end = static_cast<std::size_t>(in.gcount());
+    position = 0;
+    return end > 0;
+  }
+
+public:
+  explicit Input(std::istream &in) : in(in), buffer(BUFFER_SIZE) {}
+
+  // -1 at the end of the stream.
+  int peek() {
+    if (position == end && !fill()) {
+      return -1;
+    }
+    return static_cast<unsigned char>(buffer[position]);
+  }
+  int get() {
+    const int c = peek();
+    if (c != -1) {
+      position++;
+    }
+    return c;
+  }
+  // Reads the rest of the line without its terminator. False at the end of
+  // the stream.
+  bool line(std::string &text) {
+    text.clear();
+    int c = get();
+    if (c == -1) {
+      return false;
+    }
+    for (; c != -1 && c != '\n'; c = get()) {
+      if (c != '\r') {
+        text.push_back(static_cast<char>(c));
+      }
+    }
+    return true;
+  }
+};
+
+// Collects output and hands it to the stream in large writes.
+class Output {
+private:
+  std::ostream &out;
+  std::string buffer;
+
+public:
+  explicit Output(std::ostream &out) : out(out) {
+    buffer.reserve(BUFFER_SIZE);
+  }
+  ~Output() { flush(); }
+
+  void put(const char c) {
+    buffer.push_back(c);
+    if (buffer.size() >= BUFFER_SIZE) {
+      flush();
+    }
+  }
+  void put(const std::string_view text) {
+    buffer.append(text);
+    if (buffer.size() >= BUFFER_SIZE) {
+      flush();
+    }
+  }
+  bool flush() {
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+    return static_cast<bool>(out.flush());
+  }
+};
+
+std::string_view trim(std::string_view text) {
+  while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+    text.remove_prefix(1);
+  }
+  while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+    text.remove_suffix(1);
+  }
+  return text;
+}
+
+bool isDigit(const int c) { return c >= '0' && c <= '9'; }
+
+// Accepts "B3/S23", and the older survival-first "23/3". A bounded grid
+// suffix such as ":T100,100" is dropped.
+std::optional<Rule> parsePatternRule(std::string_view text) {
+  text = trim(text.substr(0, text.find(':')));
+  if (const auto rule = parseRule(text)) {
+    return rule;
+  }
+  const std::size_t slash = text.find('/');
+  if (slash == std::string_view::npos) {
+    return std::nullopt;
+  }
+  const std::string_view survive = text.substr(0, slash);
+  const std::string_view birth = text.substr(slash + 1);
+  for (const std::string_view part : {survive, birth}) {
+    for (const char c : part) {
+      if (!isDigit(c)) {
+        return std::nullopt;
+      }
+    }
+  }
+  return parseRule("B" + std::string(birth) + "/S" + std::string(survive));
+}
+
+bool parseCount(const std::string_view text, std::int64_t &value) {
+  const std::string digits(trim(text));
+  if (digits.empty()) {
+    return false;
+  }
+  char *end = nullptr;
+  value = std::strtoll(digits.c_str(), &end, 10);
+  return *end == '\0' && value >= 0 && value <= MAX_RUN;
+}
+
+// "x = 3, y = 3, rule = B3/S23"
+bool parseRleHeader(const std::string_view line, PatternInfo &info) {
+  std::size_t start = 0;
+  while (start <= line.size()) {
+    std::size_t comma = line.find(',', start);
+    if (comma == std::string_view::npos) {
+      comma = line.size();
+    }
+    const std::string_view field = line.substr(start, comma - start);
+    start = comma + 1;
+    const std::size_t equals = field.find('=');
+    if (equals == std::string_view::npos) {
+      return false;
+    }
+    const std::string_view key = trim(field.substr(0, equals));
+    const std::string_view value = field.substr(equals + 1);
+    if (key == "x") {
+      if (!parseCount(value, info.width)) {
+        return false;
+      }
+    } else if (key == "y") {
+      if (!parseCount(value, info.height)) {
+        return false;
+      }
+    } else if (key == "rule") {
+      info.rule = parsePatternRule(value);
+      if (!info.rule) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+std::optional<PatternInfo> readRle(Input &input, PatternSink &sink) {
+  PatternInfo info;
+  std::string line;
+  // Comment lines and the header line come first.
+  while (true) {
+    int c = input.peek();
+    while (c == '\n' || c == '\r' || c == ' ' || c == '\t') {
+      input.get();
+      c = input.peek();
+    }
+    if (c == '#') {
+      input.line(line);
+      // XLife's "#r 23/3".
+      if (line.size() > 2 && line[1] == 'r') {
+        info.rule = parsePatternRule(std::string_view(line).substr(2));
+        if (!info.rule) {
+          return std::nullopt;
+        }
+      }
+      continue;
+    }
+    if (c == 'x') {
+      input.line(line);
+      if (!parseRleHeader(line, info)) {
+        return std::nullopt;
+      }
+    }
+    break;
+  }
+
+  sink.begin(info);
+  std::int64_t x = 0;
+  std::int64_t y = 0;
+  std::int64_t count = 0;
+  for (int c = input.get(); c != -1; c = input.get()) {
+    if (isDigit(c)) {
+      count = count * 10 + (c - '0');
+      if (count > MAX_RUN) {
+        return std::nullopt;
+      }
+      continue;
+    }
+    if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+      continue;
+    }
+    const std::int64_t run = count > 0 ? count : 1;
+    count = 0;
+    if (c == 'b' || c == '.') {
+      x += run;
+    } else if (c == '$') {
+      y += run;
+      x = 0;
+    } else if (c == '!') {
+      return info;
+    } else if (c == 'o' || (c >= 'A' && c <= 'Z')) {
+      // Any state other than 0 of a multi-state pattern counts as alive.
+      sink.cells(x, y, run);
+      x += run;
+    } else {
+      return std::nullopt;
+    }
+  }
+  // A missing '!' is common enough to forgive.
+  return info;
+}
+
+std::optional<PatternInfo> readCells(Input &input, PatternSink &sink) {
+  PatternInfo info;
+  sink.begin(info);
+  std::int64_t x = 0;
+  std::int64_t y = 0;
+  std::int64_t runStart = -1;
+  bool lineStart = true;
+  const auto endRun = [&] {
+    if (runStart >= 0) {
+      sink.cells(runStart, y, x - runStart);
+      runStart = -1;
+    }
+  };
+  std::string comment;
+  for (int c = input.get(); c != -1; c = input.get()) {
+    if (lineStart && c == '!') {
+      input.line(comment);
+      continue;
+    }
+    lineStart = false;
+    if (c == 'O' || c == '*') {
+      if (runStart < 0) {
+        runStart = x;
+      }
+      x++;
+      continue;
+    }
+    endRun();
+    if (c == '.') {
+      x++;
+    } else if (c == '\n') {
+      y++;
+      x = 0;
+      lineStart = true;
+    } else if (c != '\r' && c != ' ' && c != '\t') {
+      return std::nullopt;
+    }
+  }
+  endRun();
+  return info;
+}
+
+// Leaves hold up to 8 x 8 cells, bit r * 8 + c for row r, column c.
+struct MacroNode {
+  std::uint64_t bits = 0;
+  std::uint32_t children[4] = {0, 0, 0, 0};
+  int level = 0;
+  bool leaf = false;
+};
+
+bool parseMacroLeaf(const std::string_view line, MacroNode &node) {
+  node.leaf = true;
+  node.level = 3;
+  int x = 0;
+  int y = 0;
+  for (const char c : line) {
+    if (c == '$') {
+      y++;
+      x = 0;
+    } else if (c == '.' || c == '*') {
+      if (x >= 8 || y >= 8) {
+        return false;
+      }
+      if (c == '*') {
+        node.bits |= std::uint64_t(1) << (y * 8 + x);
+      }
+      x++;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+// "level nw ne sw se"; for level 1 the four are cell states.
+bool parseMacroNode(const std::string &line,
+                    const std::vector<MacroNode> &nodes, MacroNode &node) {
+  const char *at = line.c_str();
+  char *end = nullptr;
+  std::uint64_t fields[5];
+  for (std::uint64_t &field : fields) {
+    field = std::strtoull(at, &end, 10);
+    if (end == at) {
+      return false;
+    }
+    at = end;
+  }
+  if (!trim(at).empty() || fields[0] < 1 || fields[0] > MAX_LEVEL) {
+    return false;
+  }
+  node.level = static_cast<int>(fields[0]);
+  if (node.level == 1) {
+    node.leaf = true;
+    const int offsets[4] = {0, 1, 8, 9};
+    for (int i = 0; i < 4; i++) {
+      if (fields[i + 1] > 1) {
+        return false;
+      }
+      node.bits |= fields[i + 1] << offsets[i];
+    }
+    return true;
+  }
+  for (int i = 0; i < 4; i++) {
+    const std::uint64_t child = fields[i + 1];
+    if (child >= nodes.size() ||
+        (child != 0 && nodes[child].level != node.level - 1)) {
+      return false;
+    }
+    node.children[i] = static_cast<std::uint32_t>(child);
+  }
+  return true;
+}
+
+void emitMacroNode(const std::vector<MacroNode> &nodes, const std::uint32_t id,
+                   const std::int64_t x, const std::int64_t y,
+                   PatternSink &sink) {
+  if (id == 0) {
+    return;
+  }
+  const MacroNode &node = nodes[id];
+  const std::int64_t size = std::int64_t(1) << node.level;
+  if (!sink.wants(x, y, size)) {
+    return;
+  }
+  if (node.leaf) {
+    for (int row = 0; row < size; row++) {
+      std::uint64_t bits = (node.bits >> (row * 8)) & 0xFF;
+      while (bits != 0) {
+        const int start = __builtin_ctzll(bits);
+        const int length = __builtin_ctzll(~(bits >> start));
+        sink.cells(x + start, y + row, length);
+        bits &= ~(((std::uint64_t(1) << length) - 1) << start);
+      }
+    }
+    return;
+  }
+  const std::int64_t half = size / 2;
+  emitMacroNode(nodes, node.children[0], x, y, sink);
+  emitMacroNode(nodes, node.children[1], x + half, y, sink);
+  emitMacroNode(nodes, node.children[2], x, y + half, sink);
+  emitMacroNode(nodes, node.children[3], x + half, y + half, sink);
+}
+
+std::optional<PatternInfo> readMacrocell(Input &input, PatternSink &sink) {
+  PatternInfo info;
+  std::string line;
+  if (!input.line(line) || line.compare(0, 4, "[M2]") != 0) {
+    return std::nullopt;
+  }
+  // Index 0 is the empty node of every level.
+  std::vector<MacroNode> nodes(1);
+  while (input.line(line)) {
+    if (line.empty()) {
+      continue;
+    }
+    if (line[0] == '#') {
+      if (line.size() > 2 && line[1] == 'R') {
+        info.rule = parsePatternRule(std::string_view(line).substr(2));
+        if (!info.rule) {
+          return std::nullopt;
+        }
+      } else if (line.size() > 2 && line[1] == 'G') {
+        std::int64_t generation;
+        if (!parseCount(std::string_view(line).substr(2), generation)) {
+          return std::nullopt;
+        }
+        info.generation = static_cast<std::uint64_t>(generation);
+      }
+      continue;
+    }
+    MacroNode node;
+    const bool parsed = isDigit(line[0]) ? parseMacroNode(line, nodes, node)
+                                         : parseMacroLeaf(line, node);
+    if (!parsed) {
+      return std::nullopt;
+    }
+    nodes.push_back(node);
+  }
+
+  // The last node is the root.
+  const std::uint32_t root = static_cast<std::uint32_t>(nodes.size() - 1);
+  if (root != 0) {
+    info.width = std::int64_t(1) << nodes[root].level;
+    info.height = info.width;
+  }
+  sink.begin(info);
+  emitMacroNode(nodes, root, 0, 0, sink);
+  return info;
+}
+
+// Writes cells into a board's alive bits; the board is rebuilt once the
+// whole pattern is in.
+class BoardSink : public PatternSink {
+private:
+  GameBoard &board;
+  std::int64_t originX;
+  std::int64_t originY;
+  bool centre;
+
+public:
+  BoardSink(GameBoard &board, const std::int64_t x, const std::int64_t y,
+            const bool centre)
+      : board(board), originX(x), originY(y), centre(centre) {}
+
+  void begin(const PatternInfo &info) override {
+    if (centre && info.width > 0) {
+      originX = (board.width - info.width) / 2;
+      originY = (board.height - info.height) / 2;
+    }
+  }
+  bool wants(const std::int64_t x, const std::int64_t y,
+             const std::int64_t size) override {
+    const std::int64_t left = originX + x;
+    const std::int64_t top = originY + y;
+    return left < board.width && top < board.height && left + size > 0 &&
+           top + size > 0;
+  }
+  void cells(const std::int64_t x, const std::int64_t y,
+             const std::int64_t length) override {
+    const std::int64_t row = originY + y;
+    if (row < 0 || row >= board.height) {
+      return;
+    }
+    const std::int64_t first = std::max<std::int64_t>(0, originX + x);
+    const std::int64_t last =
+        std::min<std::int64_t>(board.width, originX + x + length);
+    char *cells = board.board.data() + row * board.width;
+    for (std::int64_t i = first; i < last; i++) {
+      cells[i] |= ALIVE;
+    }
+  }
+};
+
+class SparseSink : public PatternSink {
+private:
+  SparseBoard &board;
+  std::int64_t originX;
+  std::int64_t originY;
+
+public:
+  SparseSink(SparseBoard &board, const std::int64_t x, const std::int64_t y)
+      : board(board), originX(x), originY(y) {}
+
+  void cells(const std::int64_t x, const std::int64_t y,
+             const std::int64_t length) override {
+    for (std::int64_t i = 0; i < length; i++) {
+      setCellState(board, originX + x + i, originY + y, ALIVE);
+    }
+  }
+};
+
+std::optional<PatternInfo> readIntoBoard(std::istream &in,
+                                         const PatternFormat format,
+                                         GameBoard &board, BoardSink &sink) {
+  const auto info = readPattern(in, format, sink);
+  if (info && info->rule) {
+    setRule(board, *info->rule);
+  }
+  // Even a failed read may have set some bits.
+  rebuildBoard(board);
+  return info;
+}
+
+struct Bounds {
+  int minX;
+  int minY;
+  int maxX;
+  int maxY;
+};
+
+std::optional<Bounds> liveBounds(const GameBoard &board) {
+  const AliveList &alive = board.aliveList;
+  if (alive.empty()) {
+    return std::nullopt;
+  }
+  const auto xs = std::minmax_element(alive.x.begin(), alive.x.end());
+  const auto ys = std::minmax_element(alive.y.begin(), alive.y.end());
+  return Bounds{*xs.first, *ys.first, *xs.second, *ys.second};
+}
+
+void writeRle(Output &output, const GameBoard &board) {
+  const auto bounds = liveBounds(board);
+  output.put("x = ");
+  output.put(std::to_string(bounds ? bounds->maxX - bounds->minX + 1 : 0));
+  output.put(", y = ");
+  output.put(std::to_string(bounds ? bounds->maxY - bounds->minY + 1 : 0));
+  output.put(", rule = ");
+  output.put(ruleString(board.rule));
+  output.put('\n');
+  if (!bounds) {
+    output.put("!\n");
+    return;
+  }
+
+  int column = 0;
+  const auto token = [&](const int count, const char tag) {
+    const std::string text =
+        count > 1 ? std::to_string(count) + tag : std::string(1, tag);
+    if (column + static_cast<int>(text.size()) > RLE_LINE_LENGTH) {
+      output.put('\n');
+      column = 0;
+    }
+    output.put(text);
+    column += static_cast<int>(text.size());
+  };
+  int pendingRows = 0;
+  for (int y = bounds->minY; y <= bounds->maxY; y++) {
+    const char *row = board.board.data() + static_cast<std::size_t>(y) *
+                                               board.width;
+    int x = bounds->minX;
+    while (x <= bounds->maxX) {
+      const char state = row[x] & ALIVE;
+      int end = x + 1;
+      while (end <= bounds->maxX && (row[end] & ALIVE) == state) {
+        end++;
+      }
+      // Dead cells at the end of a row are implied.
+      if (state == DEAD && end > bounds->maxX) {
+        break;
+      }
+      if (pendingRows > 0) {
+        token(pendingRows, '$');
+        pendingRows = 0;
+      }
+      token(end - x, state == ALIVE ? 'o' : 'b');
+      x = end;
+    }
+    pendingRows++;
+  }
+  token(1, '!');
+  output.put('\n');
+}
+
+void writeCells(Output &output, const GameBoard &board) {
+  const auto bounds = liveBounds(board);
+  if (!bounds) {
+    return;
+  }
+  for (int y = bounds->minY; y <= bounds->maxY; y++) {
+    const char *row = board.board.data() + static_cast<std::size_t>(y) *
+                                               board.width;
+    int last = bounds->maxX;
+    while (last >= bounds->minX && (row[last] & ALIVE) == DEAD) {
+      last--;
+    }
+    for (int x = bounds->minX; x <= last; x++) {
+      output.put((row[x] & ALIVE) ? 'O' : '.');
+    }
+    output.put('\n');
+  }
+}
+
+// Builds the quadtree bottom up, writing each distinct node the first time
+// it is seen, after its children, as the format requires.
+class MacrocellWriter {
+private:
+  struct Key {
+    std::uint32_t children[4];
+    bool operator==(const Key &other) const {
+      return std::equal(children, children + 4, other.children);
+    }
+  };
+  struct KeyHash {
+    std::size_t operator()(const Key &key) const {
+      std::uint64_t hash = 0;
+      for (const std::uint32_t child : key.children) {
+        hash = (hash ^ child) * 0x9E3779B97F4A7C15ull;
+      }
+      return static_cast<std::size_t>(hash ^ (hash >> 32));
+    }
+  };
+
+  Output &output;
+  const GameBoard &board;
+  int originX;
+  int originY;
+  std::uint32_t count = 0;
+  std::unordered_map<std::uint64_t, std::uint32_t> leaves;
+  // Children are distinct across levels, so one table serves every level.
+  std::unordered_map<Key, std::uint32_t, KeyHash> nodes;
+
+  std::uint64_t leafBits(const std::int64_t x, const std::int64_t y) const {
+    std::uint64_t bits = 0;
+    for (int row = 0; row < 8; row++) {
+      const std::int64_t cellY = originY + y + row;
+      if (cellY >= board.height) {
+        break;
+      }
+      const char *cells = board.board.data() + cellY * board.width;
+      for (int column = 0; column < 8; column++) {
+        const std::int64_t cellX = originX + x + column;
+        if (cellX >= board.width) {
+          break;
+        }
+        bits |= static_cast<std::uint64_t>(cells[cellX] & ALIVE)
+                << (row * 8 + column);
+      }
+    }
+    return bits;
+  }
+
+  std::uint32_t leaf(const std::int64_t x, const std::int64_t y) {
+    const std::uint64_t bits = leafBits(x, y);
+    if (bits == 0) {
+      return 0;
+    }
+    const auto found = leaves.emplace(bits, count + 1);
+    if (!found.second) {
+      return found.first->second;
+    }
+    count++;
+    int lastRow = 7;
+    while (((bits >> (lastRow * 8)) & 0xFF) == 0) {
+      lastRow--;
+    }
+    for (int row = 0; row <= lastRow; row++) {
+      const std::uint64_t cells = (bits >> (row * 8)) & 0xFF;
+      for (int column = 0; (cells >> column) != 0; column++) {
+        output.put(((cells >> column) & 1) ? '*' : '.');
+      }
+      output.put('$');
+    }
+    output.put('\n');
+    return count;
+  }
+
+public:
+  MacrocellWriter(Output &output, const GameBoard &board, const int originX,
+                  const int originY)
+      : output(output), board(board), originX(originX), originY(originY) {}
+
+  std::uint32_t build(const int level, const std::int64_t x,
+                      const std::int64_t y) {
+    if (originX + x >= board.width || originY + y >= board.height) {
+      return 0;
+    }
+    if (level == 3) {
+      return leaf(x, y);
+    }
+    const std::int64_t half = std::int64_t(1) << (level - 1);
+    Key key{{build(level - 1, x, y), build(level - 1, x + half, y),
+             build(level - 1, x, y + half),
+             build(level - 1, x + half, y + half)}};
+    if (key == Key{{0, 0, 0, 0}}) {
+      return 0;
+    }
+    const auto found = nodes.emplace(key, count + 1);
+    if (!found.second) {
+      return found.first->second;
+    }
+    count++;
+    output.put(std::to_string(level));
+    for (const std::uint32_t child : key.children) {
+      output.put(' ');
+      output.put(std::to_string(child));
+    }
+    output.put('\n');
+    return count;
+  }
+};
+
+void writeMacrocell(Output &output, const GameBoard &board,
+                    const std::uint64_t generation) {
+  output.put("[M2] (life)\n#R ");
+  output.put(ruleString(board.rule));
+  output.put('\n');
+  if (generation > 0) {
+    output.put("#G ");
+    output.put(std::to_string(generation));
+    output.put('\n');
+  }
+  const auto bounds = liveBounds(board);
+  if (!bounds) {
+    return;
+  }
+  const int side = std::max(bounds->maxX - bounds->minX + 1,
+                            bounds->maxY - bounds->minY + 1);
+  int level = 3;
+  while ((std::int64_t(1) << level) < side) {
+    level++;
+  }
+  MacrocellWriter writer(output, board, bounds->minX, bounds->minY);
+  writer.build(level, 0, 0);
+}
+} // namespace
+
+std::optional<PatternFormat> patternFormatFor(const std::string_view path) {
+  const auto endsWith = [&](const std::string_view suffix) {
+    return path.size() >= suffix.size() &&
+           path.substr(path.size() - suffix.size()) == suffix;
+  };
+  if (endsWith(".rle")) {
+    return PatternFormat::RLE;
+  }
+  if (endsWith(".cells")) {
+    return PatternFormat::CELLS;
+  }
+  if (endsWith(".mc")) {
+    return PatternFormat::MACROCELL;
+  }
+  return std::nullopt;
+}
+
+std::optional<PatternInfo> readPattern(std::istream &in,
+                                       const PatternFormat format,
+                                       PatternSink &sink) {
+  Input input(in);
+  switch (format) {
+  case PatternFormat::RLE:
+    return readRle(input, sink);
+  case PatternFormat::CELLS:
+    return readCells(input, sink);
+  case PatternFormat::MACROCELL:
+    return readMacrocell(input, sink);
+  }
+  return std::nullopt;
+}
+
+std::optional<PatternInfo> readPattern(std::istream &in,
+                                       const PatternFormat format,
+                                       GameBoard &board, const int x,
+                                       const int y) {
+  BoardSink sink(board, x, y, false);
+  return readIntoBoard(in, format, board, sink);
+}
+
+std::optional<PatternInfo> readPattern(std::istream &in,
+                                       const PatternFormat format,
+                                       SparseBoard &board, const std::int64_t x,
+                                       const std::int64_t y) {
+  SparseSink sink(board, x, y);
+  return readPattern(in, format, sink);
+}
+
+std::optional<PatternInfo> loadPattern(const std::string &path,
+                                       GameBoard &board) {
+  const auto format = patternFormatFor(path);
+  std::ifstream in(path, std::ios::binary);
+  if (!format || !in) {
+    return std::nullopt;
+  }
+  BoardSink sink(board, 0, 0, true);
+  return readIntoBoard(in, *format, board, sink);
+}
+
+bool writePattern(std::ostream &out, const PatternFormat format,
+                  const GameBoard &board, const std::uint64_t generation) {
+  Output output(out);
+  switch (format) {
+  case PatternFormat::RLE:
+    writeRle(output, board);
+    break;
+  case PatternFormat::CELLS:
+    writeCells(output, board);
+    break;
+  case PatternFormat::MACROCELL:
+    writeMacrocell(output, board, generation);
+    break;
+  }
+  return output.flush();
+}
+
+bool savePattern(const std::string &path, const GameBoard &board,
+                 const std::uint64_t generation) {
+  const auto format = patternFormatFor(path);
+  if (!format) {
+    return false;
+  }
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  return out && writePattern(out, *format, board, generation);
+}
+} // namespace life
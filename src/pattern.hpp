@@ -0,0 +1,82 @@
+// pattern.hpp
+#ifndef PATTERN_H
+#define PATTERN_H
+
+#include "life.hpp"
+#include "sparseboard.hpp"
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace life {
+
+enum class PatternFormat {
+    // Run-length encoded, ".rle".
+    RLE,
+    // Plaintext, one character per cell, ".cells".
+    CELLS,
+    // Golly's macrocell quadtree, ".mc".
+    MACROCELL,
+};
+
+// By file extension. Returns nothing for an unknown extension.
+std::optional<PatternFormat> patternFormatFor(std::string_view path);
+
+// What a pattern file says about itself besides its cells.
+struct PatternInfo {
+    // The declared size: the RLE header's x and y, or the macrocell root's
+    // side. 0 when the format has none, as in plaintext.
+    std::int64_t width = 0;
+    std::int64_t height = 0;
+    std::optional<Rule> rule;
+    // The macrocell "#G" line.
+    std::uint64_t generation = 0;
+};
+
+// Receives the live cells a reader decodes, as horizontal runs, relative
+// to the pattern's top-left corner. For a macrocell file that is the
+// root's corner.
+class PatternSink {
+public:
+  virtual ~PatternSink() = default;
+  // Called once, before any cells.
+  virtual void begin(const PatternInfo &) {}
+  // Whether any cell of the size x size square at (x, y) is wanted; the
+  // macrocell reader skips the subtrees that are not.
+  virtual bool wants(std::int64_t, std::int64_t, std::int64_t) {
+    return true;
+  }
+  virtual void cells(std::int64_t x, std::int64_t y, std::int64_t length) = 0;
+};
+
+// The readers decode as they read, through a fixed-size buffer, so the text
+// is never held whole. Macrocell keeps its node table, which is the
+// pattern's compressed form rather than a grid. Returns nothing if the
+// text is malformed; cells decoded before the error have been delivered.
+std::optional<PatternInfo> readPattern(std::istream &in, PatternFormat format,
+                                       PatternSink &sink);
+// Sets the alive bit of the cells inside the board, placing the pattern's
+// top-left at (x, y), then rebuilds the board once. Cells already alive stay
+// alive. A declared rule replaces the board's.
+std::optional<PatternInfo> readPattern(std::istream &in, PatternFormat format,
+                                       GameBoard &board, int x = 0, int y = 0);
+std::optional<PatternInfo> readPattern(std::istream &in, PatternFormat format,
+                                       SparseBoard &board, std::int64_t x = 0,
+                                       std::int64_t y = 0);
+// Reads the file in the format its extension names into the board,
+// centred when the format declares a size.
+std::optional<PatternInfo> loadPattern(const std::string &path,
+                                       GameBoard &board);
+
+// Write the board's live cells, trimmed to their bounding box, with its
+// rule. Returns false if the stream failed.
+bool writePattern(std::ostream &out, PatternFormat format,
+                  const GameBoard &board, std::uint64_t generation = 0);
+bool savePattern(const std::string &path, const GameBoard &board,
+                 std::uint64_t generation = 0);
+} // namespace life
+
+#endif // PATTERN_H
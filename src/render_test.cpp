@@ -0,0 +1,153 @@
+// render_test.cpp
+//
+// Draws boards with each backend through SDL's software renderer, so no
+// display is needed, and compares the pixels.
+#include "Renderer.hpp"
+#include "life.hpp"
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int CELL_SIZE = 3;
+
+class RenderTest : public ::testing::Test {
+protected:
+  life::GameBoard board = life::genBoard(16, 24);
+  SDL_Surface *surface = nullptr;
+  SDL_Renderer *renderer = nullptr;
+
+  void SetUp() override {
+    surface = SDL_CreateSurface(board.width * CELL_SIZE,
+                                board.height * CELL_SIZE,
+                                SDL_PIXELFORMAT_XRGB8888);
+    ASSERT_NE(surface, nullptr) << SDL_GetError();
+    renderer = SDL_CreateSoftwareRenderer(surface);
+    ASSERT_NE(renderer, nullptr) << SDL_GetError();
+
+    // A glider, a blinker and cells on every edge and corner.
+    const int cells[][2] = {{1, 0},  {2, 1},  {0, 2},  {1, 2},   {2, 2},
+                            {10, 7}, {11, 7}, {12, 7}, {23, 0},  {0, 15},
+                            {23, 15}, {5, 15}, {23, 9}};
+    for (const auto &cell : cells) {
+      life::setCellState(board, cell[0], cell[1], life::ALIVE);
+    }
+  }
+
+  void TearDown() override {
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroySurface(surface);
+  }
+
+  // Clears to black, draws with the given backend and reads back one bool
+  // per pixel, true where it is white.
+  std::vector<bool> render(life::Renderer &boardRenderer,
+                           const life::RenderBackend backend) {
+    boardRenderer.setBackend(backend);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
+    SDL_RenderClear(renderer);
+    EXPECT_TRUE(boardRenderer.draw(board, CELL_SIZE)) << SDL_GetError();
+    SDL_Surface *pixels = SDL_RenderReadPixels(renderer, nullptr);
+    EXPECT_NE(pixels, nullptr) << SDL_GetError();
+    std::vector<bool> white;
+    for (int y = 0; y < pixels->h; y++) {
+      for (int x = 0; x < pixels->w; x++) {
+        Uint8 r = 0, g = 0, b = 0, a = 0;
+        SDL_ReadSurfacePixel(pixels, x, y, &r, &g, &b, &a);
+        white.push_back(r == 255 && g == 255 && b == 255);
+      }
+    }
+    SDL_DestroySurface(pixels);
+    return white;
+  }
+
+  std::vector<bool> expected() const {
+    const int width = board.width * CELL_SIZE;
+    std::vector<bool> white(
+        static_cast<std::size_t>(width) * board.height * CELL_SIZE, false);
+    for (int y = 0; y < board.height * CELL_SIZE; y++) {
+      for (int x = 0; x < width; x++) {
+        white[y * width + x] = life::getCellState(board, x / CELL_SIZE,
+                                                  y / CELL_SIZE) == life::ALIVE;
+      }
+    }
+    return white;
+  }
+};
+
+TEST_F(RenderTest, PointsMatchesBoard) {
+  life::Renderer boardRenderer(renderer);
+  EXPECT_EQ(render(boardRenderer, life::RenderBackend::POINTS), expected());
+}
+
+TEST_F(RenderTest, RectsMatchesBoard) {
+  life::Renderer boardRenderer(renderer);
+  EXPECT_EQ(render(boardRenderer, life::RenderBackend::RECTS), expected());
+}
+
+TEST_F(RenderTest, TextureMatchesBoard) {
+  life::Renderer boardRenderer(renderer);
+  EXPECT_EQ(render(boardRenderer, life::RenderBackend::TEXTURE), expected());
+}
+
+// Triangle rasterisation may differ from rect fills on the cell edges, so
+// only the centre pixel of each cell is compared.
+TEST_F(RenderTest, GeometryCoversCellCentres) {
+  life::Renderer boardRenderer(renderer);
+  const std::vector<bool> white =
+      render(boardRenderer, life::RenderBackend::GEOMETRY);
+  const int width = board.width * CELL_SIZE;
+  for (int y = 0; y < board.height; y++) {
+    for (int x = 0; x < board.width; x++) {
+      const int centre = (y * CELL_SIZE + CELL_SIZE / 2) * width +
+                         x * CELL_SIZE + CELL_SIZE / 2;
+      EXPECT_EQ(white[centre], life::getCellState(board, x, y) == life::ALIVE)
+          << "cell " << x << "," << y;
+    }
+  }
+}
+
+// Drawing again after the board changes reuses the batches and texture.
+TEST_F(RenderTest, RedrawAfterStep) {
+  life::Renderer boardRenderer(renderer);
+  for (const auto backend :
+       {life::RenderBackend::RECTS, life::RenderBackend::TEXTURE}) {
+    render(boardRenderer, backend);
+  }
+  life::iterateBoard(board);
+  EXPECT_EQ(render(boardRenderer, life::RenderBackend::RECTS), expected());
+  EXPECT_EQ(render(boardRenderer, life::RenderBackend::TEXTURE), expected());
+}
+
+// Patching only the changed tiles keeps the persistent texture in step with
+// the board across steps, edits and switches between backends.
+TEST_F(RenderTest, DiffPatchesMatchBoard) {
+  life::Renderer boardRenderer(renderer);
+  life::trackChanges(board, true);
+  for (int generation = 0; generation < 12; generation++) {
+    ASSERT_EQ(render(boardRenderer, life::RenderBackend::DIFF), expected())
+        << "generation " << generation;
+    life::clearChanges(board);
+    life::iterateBoard(board);
+    if (generation == 5) {
+      life::setCellState(board, 20, 3, life::ALIVE);
+      render(boardRenderer, life::RenderBackend::TEXTURE);
+    }
+  }
+}
+
+TEST(RenderBackendTest, CyclesThroughEveryBackend) {
+  life::RenderBackend backend = life::RenderBackend::RECTS;
+  std::vector<std::string> names;
+  for (int i = 0; i < 5; i++) {
+    names.emplace_back(life::renderBackendName(backend));
+    backend = life::nextRenderBackend(backend);
+  }
+  EXPECT_EQ(backend, life::RenderBackend::RECTS);
+  EXPECT_EQ(names, (std::vector<std::string>{"rects", "geometry", "texture",
+                                             "diff", "points"}));
+}
+
+} // namespace
@@ -0,0 +1,253 @@
+// snapshot.cpp
+#include "./snapshot.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+              "snapshots are written in host byte order");
+
+namespace life {
+namespace {
+using Word = std::uint64_t;
+
+constexpr char MAGIC[8] = {'L', 'I', 'F', 'E', 'S', 'N', 'A', 'P'};
+constexpr std::uint32_t VERSION = 1;
+
+inline std::size_t wordsPerRow(const int width) {
+  return (static_cast<std::size_t>(width) + 63) / 64;
+}
+
+void putVarint(std::string &out, std::uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+bool getVarint(const unsigned char *&at, const unsigned char *end,
+               std::uint64_t &value) {
+  value = 0;
+  for (int shift = 0; shift < 64 && at < end; shift += 7) {
+    const unsigned char byte = *at++;
+    value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::string encodeRuns(const Snapshot &snapshot) {
+  std::string out;
+  const std::size_t stride = wordsPerRow(snapshot.width);
+  Word current = 0;
+  std::uint64_t run = 0;
+  for (int y = 0; y < snapshot.height; y++) {
+    const Word *row = snapshot.bits.data() + y * stride;
+    for (int x = 0; x < snapshot.width; x++) {
+      const Word cell = (row[x / 64] >> (x % 64)) & 1;
+      if (cell != current) {
+        putVarint(out, run);
+        current = cell;
+        run = 0;
+      }
+      run++;
+    }
+  }
+  putVarint(out, run);
+  return out;
+}
+
+// Both decoders write bare alive bits; rebuildBoard does the rest.
+bool decodeBits(const unsigned char *payload, const std::uint64_t bytes,
+                GameBoard &board) {
+  const std::size_t stride = wordsPerRow(board.width);
+  if (bytes != stride * board.height * sizeof(Word)) {
+    return false;
+  }
+  char *cells = board.board.data();
+  for (int y = 0; y < board.height; y++) {
+    char *out = cells + static_cast<std::size_t>(y) * board.width;
+    for (std::size_t i = 0; i < stride; i++) {
+      Word word;
+      std::memcpy(&word, payload + (y * stride + i) * sizeof(Word),
+                  sizeof(word));
+      const int first = static_cast<int>(i * 64);
+      const int last = std::min(board.width, first + 64);
+      for (int x = first; x < last; x++) {
+        out[x] = static_cast<char>((word >> (x - first)) & 1);
+      }
+    }
+  }
+  return true;
+}
+
+bool decodeRuns(const unsigned char *payload, const std::uint64_t bytes,
+                GameBoard &board) {
+  const unsigned char *at = payload;
+  const unsigned char *end = payload + bytes;
+  const std::uint64_t cells = board.board.size();
+  std::uint64_t position = 0;
+  char state = DEAD;
+  while (at < end) {
+    std::uint64_t run;
+    if (!getVarint(at, end, run) || run > cells - position) {
+      return false;
+    }
+    if (state == ALIVE) {
+      std::memset(board.board.data() + position, ALIVE, run);
+    }
+    position += run;
+    state = state == ALIVE ? DEAD : ALIVE;
+  }
+  return position == cells;
+}
+
+// Owns a read-only mapping of a whole file.
+class MappedFile {
+public:
+  explicit MappedFile(const std::string &path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+      void *mapped = ::mmap(nullptr, static_cast<std::size_t>(info.st_size),
+                            PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapped != MAP_FAILED) {
+        ::madvise(mapped, static_cast<std::size_t>(info.st_size),
+                  MADV_SEQUENTIAL);
+        data = static_cast<const unsigned char *>(mapped);
+        size = static_cast<std::size_t>(info.st_size);
+      }
+    }
+    ::close(fd);
+  }
+  ~MappedFile() {
+    if (data != nullptr) {
+      ::munmap(const_cast<unsigned char *>(data), size);
+    }
+  }
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  const unsigned char *data = nullptr;
+  std::size_t size = 0;
+};
+} // namespace
+
+Snapshot captureSnapshot(const GameBoard &board,
+                         const std::uint64_t generation) {
+  Snapshot snapshot;
+  snapshot.height = board.height;
+  snapshot.width = board.width;
+  snapshot.generation = generation;
+  snapshot.rule = board.rule;
+  snapshot.boundary = board.boundary;
+  const std::size_t stride = wordsPerRow(board.width);
+  snapshot.bits.assign(stride * board.height, 0);
+  const char *cells = board.board.data();
+  for (int y = 0; y < board.height; y++) {
+    const char *row = cells + static_cast<std::size_t>(y) * board.width;
+    Word *out = snapshot.bits.data() + y * stride;
+    for (int x = 0; x < board.width; x++) {
+      out[x / 64] |= static_cast<Word>(row[x] & ALIVE) << (x % 64);
+    }
+  }
+  return snapshot;
+}
+
+bool saveSnapshot(const std::string &path, const Snapshot &snapshot,
+                  const SnapshotEncoding encoding) {
+  std::string runs;
+  const char *payload = reinterpret_cast<const char *>(snapshot.bits.data());
+  std::uint64_t payloadBytes = snapshot.bits.size() * sizeof(Word);
+  if (encoding == SnapshotEncoding::RUNS) {
+    runs = encodeRuns(snapshot);
+    payload = runs.data();
+    payloadBytes = runs.size();
+  }
+
+  SnapshotHeader header{};
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.encoding = static_cast<std::uint32_t>(encoding);
+  header.height = snapshot.height;
+  header.width = snapshot.width;
+  header.generation = snapshot.generation;
+  header.birth = snapshot.rule.birth;
+  header.survive = snapshot.rule.survive;
+  header.boundary = static_cast<std::uint32_t>(snapshot.boundary);
+  header.payloadBytes = payloadBytes;
+
+  const std::string temporary = path + ".tmp";
+  {
+    std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(payload, static_cast<std::streamsize>(payloadBytes));
+    if (!out.flush()) {
+      std::remove(temporary.c_str());
+      return false;
+    }
+  }
+  return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+std::future<bool> saveSnapshotAsync(std::string path, Snapshot snapshot,
+                                    const SnapshotEncoding encoding) {
+  return std::async(std::launch::async,
+                    [path = std::move(path), snapshot = std::move(snapshot),
+                     encoding] { return saveSnapshot(path, snapshot, encoding); });
+}
+
+std::optional<LoadedSnapshot> loadSnapshot(const std::string &path) {
+  const MappedFile file(path);
+  SnapshotHeader header;
+  if (file.data == nullptr || file.size < sizeof(header)) {
+    return std::nullopt;
+  }
+  std::memcpy(&header, file.data, sizeof(header));
+  if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      header.version != VERSION || header.height <= 0 || header.width <= 0 ||
+      header.payloadBytes != file.size - sizeof(header) ||
+      header.birth > 0x1FF || header.survive > 0x1FF ||
+      header.boundary > static_cast<std::uint32_t>(Boundary::KLEIN)) {
+    return std::nullopt;
+  }
+  // GameBoard indexes its cells with int.
+  if (static_cast<std::uint64_t>(header.height) * header.width > INT_MAX) {
+    return std::nullopt;
+  }
+
+  LoadedSnapshot loaded;
+  loaded.board = genBoard(header.height, header.width,
+                          static_cast<Boundary>(header.boundary));
+  loaded.board.rule = Rule{header.birth, header.survive};
+  loaded.generation = header.generation;
+  const unsigned char *payload = file.data + sizeof(header);
+  bool decoded = false;
+  if (header.encoding == static_cast<std::uint32_t>(SnapshotEncoding::BITS)) {
+    loaded.encoding = SnapshotEncoding::BITS;
+    decoded = decodeBits(payload, header.payloadBytes, loaded.board);
+  } else if (header.encoding ==
+             static_cast<std::uint32_t>(SnapshotEncoding::RUNS)) {
+    loaded.encoding = SnapshotEncoding::RUNS;
+    decoded = decodeRuns(payload, header.payloadBytes, loaded.board);
+  }
+  if (!decoded) {
+    return std::nullopt;
+  }
+  rebuildBoard(loaded.board);
+  return loaded;
+}
+} // namespace life
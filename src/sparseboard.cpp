@@ -0,0 +1,242 @@
+// sparseboard.cpp
+#include "./sparseboard.hpp"
+#include "./bitkernel.hpp"
+
+#include <cstring>
+
+namespace life {
+namespace {
+using Word = std::uint64_t;
+using bitkernel::lifeKernel;
+using bitkernel::ScalarOps;
+
+const SparseTile EMPTY_TILE{};
+
+inline std::int64_t floorDiv(const std::int64_t value, const std::int64_t by) {
+  return value >= 0 ? value / by : -((-value + by - 1) / by);
+}
+
+inline bool onPlane(const std::int64_t tx, const std::int64_t ty) {
+  return tx >= -SPARSE_PLANE_TILES && tx < SPARSE_PLANE_TILES &&
+         ty >= -SPARSE_PLANE_TILES && ty < SPARSE_PLANE_TILES;
+}
+
+// Only for tiles onPlane; anything further out would share a key.
+inline std::uint64_t tileKey(const std::int64_t tx, const std::int64_t ty) {
+  return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(tx)) << 32) |
+         static_cast<std::uint32_t>(ty);
+}
+
+inline std::int64_t keyX(const std::uint64_t key) {
+  return static_cast<std::int32_t>(key >> 32);
+}
+
+inline std::int64_t keyY(const std::uint64_t key) {
+  return static_cast<std::int32_t>(key & 0xFFFFFFFFu);
+}
+
+const SparseTile &tileAt(const SparseBoard &board, const std::int64_t tx,
+                         const std::int64_t ty) {
+  if (!onPlane(tx, ty)) {
+    return EMPTY_TILE;
+  }
+  const auto found = board.tiles.find(tileKey(tx, ty));
+  return found == board.tiles.end() ? EMPTY_TILE : *found->second;
+}
+
+bool isEmpty(const Word *rows) {
+  Word any = 0;
+  for (int r = 0; r < SPARSE_TILE_SIZE; r++) {
+    any |= rows[r];
+  }
+  return any == 0;
+}
+
+// Steps one tile into next, its SPARSE_TILE_SIZE rows of scratch.
+void stepTile(const SparseBoard &board, const std::uint64_t key,
+              const SparseTile &tile, Word *next) {
+  const std::int64_t tx = keyX(key);
+  const std::int64_t ty = keyY(key);
+  const Word *n = tileAt(board, tx, ty - 1).rows;
+  const Word *s = tileAt(board, tx, ty + 1).rows;
+  const Word *w = tileAt(board, tx - 1, ty).rows;
+  const Word *e = tileAt(board, tx + 1, ty).rows;
+  const Word *nw = tileAt(board, tx - 1, ty - 1).rows;
+  const Word *ne = tileAt(board, tx + 1, ty - 1).rows;
+  const Word *sw = tileAt(board, tx - 1, ty + 1).rows;
+  const Word *se = tileAt(board, tx + 1, ty + 1).rows;
+  const Word *c = tile.rows;
+  constexpr int last = SPARSE_TILE_SIZE - 1;
+  for (int r = 0; r < SPARSE_TILE_SIZE; r++) {
+    const bool top = r == 0;
+    const bool bottom = r == last;
+    next[r] = lifeKernel<ScalarOps>(
+        top ? nw[last] : w[r - 1], top ? n[last] : c[r - 1],
+        top ? ne[last] : e[r - 1], w[r], c[r], e[r],
+        bottom ? sw[0] : w[r + 1], bottom ? s[0] : c[r + 1],
+        bottom ? se[0] : e[r + 1]);
+  }
+}
+} // namespace
+
+SparseBoard::SparseBoard(const SparseBoard &other) {
+  tiles.reserve(other.tiles.size());
+  for (const auto &entry : other.tiles) {
+    tiles.emplace(entry.first, pool.create<SparseTile>(*entry.second));
+  }
+}
+
+SparseBoard &SparseBoard::operator=(const SparseBoard &other) {
+  if (this != &other) {
+    *this = SparseBoard(other);
+  }
+  return *this;
+}
+
+SparseBoard genSparseBoard() { return SparseBoard(); }
+
+char getCellState(const SparseBoard &board, const std::int64_t x,
+                  const std::int64_t y) {
+  const std::int64_t tx = floorDiv(x, SPARSE_TILE_SIZE);
+  const std::int64_t ty = floorDiv(y, SPARSE_TILE_SIZE);
+  const Word row = tileAt(board, tx, ty).rows[y - ty * SPARSE_TILE_SIZE];
+  return static_cast<char>((row >> (x - tx * SPARSE_TILE_SIZE)) & 1);
+}
+
+void setCellState(SparseBoard &board, const std::int64_t x,
+                  const std::int64_t y, const char state) {
+  const std::int64_t tx = floorDiv(x, SPARSE_TILE_SIZE);
+  const std::int64_t ty = floorDiv(y, SPARSE_TILE_SIZE);
+  if (!onPlane(tx, ty)) {
+    return;
+  }
+  const std::uint64_t key = tileKey(tx, ty);
+  auto found = board.tiles.find(key);
+  if (found == board.tiles.end()) {
+    if (state != ALIVE) {
+      return;
+    }
+    found = board.tiles.emplace(key, board.pool.create<SparseTile>()).first;
+  }
+  Word &row = found->second->rows[y - ty * SPARSE_TILE_SIZE];
+  const Word bit = Word(1) << (x - tx * SPARSE_TILE_SIZE);
+  row = state == ALIVE ? (row | bit) : (row & ~bit);
+  if (state != ALIVE && isEmpty(found->second->rows)) {
+    board.pool.destroy(found->second);
+    board.tiles.erase(found);
+  }
+}
+
+int neighborCount(const SparseBoard &board, const std::int64_t x,
+                  const std::int64_t y) {
+  int count = 0;
+  for (std::int64_t j = y - 1; j <= y + 1; j++) {
+    for (std::int64_t i = x - 1; i <= x + 1; i++) {
+      if (i != x || j != y) {
+        count += getCellState(board, i, j);
+      }
+    }
+  }
+  return count;
+}
+
+void iterateBoard(SparseBoard &board) {
+  // Births can spill into an absent neighbour only across an edge that
+  // has live cells on it, so add just those neighbours, empty, for now.
+  constexpr int last = SPARSE_TILE_SIZE - 1;
+  board.frontier.clear();
+  for (const auto &entry : board.tiles) {
+    const Word *rows = entry.second->rows;
+    Word west = 0;
+    Word east = 0;
+    for (int r = 0; r < SPARSE_TILE_SIZE; r++) {
+      west |= rows[r] & 1;
+      east |= rows[r] >> last;
+    }
+    const bool edges[3][3] = {
+        {(rows[0] & 1) != 0, rows[0] != 0, (rows[0] >> last) != 0},
+        {west != 0, false, east != 0},
+        {(rows[last] & 1) != 0, rows[last] != 0, (rows[last] >> last) != 0},
+    };
+    const std::int64_t tx = keyX(entry.first);
+    const std::int64_t ty = keyY(entry.first);
+    for (int dy = -1; dy <= 1; dy++) {
+      for (int dx = -1; dx <= 1; dx++) {
+        if (!edges[dy + 1][dx + 1] || !onPlane(tx + dx, ty + dy)) {
+          continue;
+        }
+        const std::uint64_t key = tileKey(tx + dx, ty + dy);
+        if (board.tiles.count(key) == 0) {
+          board.frontier.push_back(key);
+        }
+      }
+    }
+  }
+  for (const std::uint64_t key : board.frontier) {
+    const auto inserted = board.tiles.try_emplace(key, nullptr);
+    if (inserted.second) {
+      inserted.first->second = board.pool.create<SparseTile>();
+    }
+  }
+
+  // Every tile reads its neighbours' current rows, so the next generation
+  // goes to scratch, in map order, until all are stepped.
+  board.scratch.reset();
+  Word *next =
+      board.scratch.allocate<Word>(board.tiles.size() * SPARSE_TILE_SIZE);
+  std::size_t index = 0;
+  for (const auto &entry : board.tiles) {
+    stepTile(board, entry.first, *entry.second,
+             next + index * SPARSE_TILE_SIZE);
+    index++;
+  }
+  index = 0;
+  for (auto it = board.tiles.begin(); it != board.tiles.end(); index++) {
+    SparseTile *tile = it->second;
+    std::memcpy(tile->rows, next + index * SPARSE_TILE_SIZE,
+                sizeof(tile->rows));
+    if (isEmpty(tile->rows)) {
+      board.pool.destroy(tile);
+      it = board.tiles.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+std::uint64_t population(const SparseBoard &board) {
+  std::uint64_t count = 0;
+  for (const auto &entry : board.tiles) {
+    for (const Word row : entry.second->rows) {
+      count += static_cast<std::uint64_t>(__builtin_popcountll(row));
+    }
+  }
+  return count;
+}
+
+SparseBoard toSparseBoard(const GameBoard &gameBoard) {
+  SparseBoard board = genSparseBoard();
+  for (int y = 0; y < gameBoard.height; y++) {
+    for (int x = 0; x < gameBoard.width; x++) {
+      if (getCellState(gameBoard, x, y) == ALIVE) {
+        setCellState(board, x, y, ALIVE);
+      }
+    }
+  }
+  return board;
+}
+
+GameBoard toGameBoard(const SparseBoard &board, const std::int64_t x,
+                      const std::int64_t y, const int height,
+                      const int width) {
+  GameBoard gameBoard = genBoard(height, width);
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i++) {
+      if (getCellState(board, x + i, y + j) == ALIVE) {
+        setCellState(gameBoard, i, j, ALIVE);
+      }
+    }
+  }
+  return gameBoard;
+}
+} // namespace life
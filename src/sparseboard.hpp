@@ -0,0 +1,63 @@
+// sparseboard.hpp
+#ifndef SPARSEBOARD_H
+#define SPARSEBOARD_H
+
+#include "Arena.hpp"
+#include "life.hpp"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace life {
+
+// Side of a SparseBoard tile; one 64-bit word per tile row.
+constexpr int SPARSE_TILE_SIZE = 64;
+
+struct alignas(CACHE_LINE) SparseTile {
+    std::uint64_t rows[SPARSE_TILE_SIZE];
+};
+
+// Tile coordinates run from -SPARSE_PLANE_TILES to SPARSE_PLANE_TILES - 1,
+// so a tile key holds each in 32 bits: the plane is 2^37 cells each way of
+// the origin. Cells beyond that are dead, as past a dead boundary; writes
+// there are ignored.
+constexpr std::int64_t SPARSE_PLANE_TILES = std::int64_t(1) << 31;
+
+// A plane far larger than any pattern memory can hold. Tiles are kept in
+// a hash map keyed by tile coordinates, allocated only where cells are
+// alive and freed once they empty out, so memory follows the live
+// population rather than the bounding box. Steps Conway's rule only.
+struct SparseBoard {
+    // Tiles come from the board's own pool, so the tiles a step creates
+    // and frees along the edge of the pattern are recycled rather than
+    // going through the global allocator.
+    TilePool pool{sizeof(SparseTile)};
+    std::unordered_map<std::uint64_t, SparseTile *> tiles;
+    // Scratch: keys of empty tiles that may see births this step.
+    std::vector<std::uint64_t> frontier;
+    // Scratch for one step: the tiles' next generation, in map order.
+    ScratchArena scratch;
+
+    SparseBoard() = default;
+    SparseBoard(const SparseBoard &other);
+    SparseBoard &operator=(const SparseBoard &other);
+    SparseBoard(SparseBoard &&other) = default;
+    SparseBoard &operator=(SparseBoard &&other) = default;
+};
+
+SparseBoard genSparseBoard();
+int neighborCount(const SparseBoard &board, std::int64_t x, std::int64_t y);
+char getCellState(const SparseBoard &board, std::int64_t x, std::int64_t y);
+void setCellState(SparseBoard &board, std::int64_t x, std::int64_t y,
+                  char state);
+void iterateBoard(SparseBoard &board);
+std::uint64_t population(const SparseBoard &board);
+
+// Copies the live cells of a GameBoard with its (0, 0) at the plane's
+// (0, 0), and back out of the height x width window at (x, y).
+SparseBoard toSparseBoard(const GameBoard &gameBoard);
+GameBoard toGameBoard(const SparseBoard &board, std::int64_t x, std::int64_t y,
+                      int height, int width);
+} // namespace life
+
+#endif // SPARSEBOARD_H
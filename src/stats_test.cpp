@@ -1,10 +1,14 @@
 // test_stats.cpp
 #include "Stats.hpp"
+#include "Telemetry.hpp"
 #include "gtest/gtest.h"
 #include <iostream> // For std::streambuf, std::cout
 #include <memory>   // For std::unique_ptr
 #include <sstream>  // For std::stringstream to capture cout
 #include <string>   // For std::string
+#include <chrono>
+#include <thread>
+#include <vector>
 
 // Helper class to redirect std::cout to a std::stringstream
 class CoutRedirector {
@@ -177,6 +181,216 @@ TEST_F(StatsTest, PredefinedNames) {
   EXPECT_EQ(output, ss_expected.str());
 }
 
+// Test case: the legacy API owns its keys, so a name built in a temporary
+// string is still readable when printed
+TEST_F(StatsTest, TemporaryNamesOutliveTheirStrings) {
+  for (int i = 0; i < 3; i++) {
+    s.set(std::string("Value") + std::to_string(i), i * 10);
+  }
+  s.start(std::string("Temp"), 5);
+  s.stop(std::string("Temp"), 9);
+  s.print();
+  EXPECT_EQ(getCapturedOutput(), "Statistics:\nTemp: 4 ms\nValue0: 0\n"
+                                 "Value1: 10\nValue2: 20\n");
+}
+
+// Test case: registering is idempotent and ids are dense
+TEST_F(StatsTest, RegisterTimerReturnsStableIds) {
+  const life::StatId iterate = s.registerTimer(life::ITERATE);
+  const life::StatId render = s.registerTimer(life::RENDER);
+  EXPECT_EQ(0, iterate);
+  EXPECT_EQ(1, render);
+  EXPECT_EQ(iterate, s.registerTimer(std::string("Iterate")));
+}
+
+// Test case: samples far below a millisecond are kept, not rounded to 0
+TEST_F(StatsTest, TimerKeepsNanosecondSamples) {
+  const life::StatId id = s.registerTimer(life::ITERATE);
+  s.record(id, 400000); // 0.4 ms
+  const life::Histogram &h = s.histogram(id);
+  EXPECT_EQ(1u, h.count());
+  EXPECT_EQ(400000u, h.max());
+  EXPECT_EQ(400000u, h.percentile(0.5));
+  EXPECT_EQ(400000u, h.mean());
+}
+
+// Test case: percentiles are exact below 64 ns and within 1/32 above
+TEST_F(StatsTest, HistogramPercentiles) {
+  life::Histogram small;
+  for (Uint64 v = 1; v <= 50; v++) {
+    small.record(v);
+  }
+  EXPECT_EQ(25u, small.percentile(0.50));
+  EXPECT_EQ(50u, small.percentile(0.99));
+  EXPECT_EQ(50u, small.max());
+
+  life::Histogram h;
+  for (Uint64 v = 1; v <= 100000; v++) {
+    h.record(v * 1000);
+  }
+  const auto near = [](Uint64 actual, Uint64 expected) {
+    const double error = static_cast<double>(actual) / expected - 1.0;
+    return error >= 0.0 && error <= 1.0 / 32;
+  };
+  EXPECT_TRUE(near(h.percentile(0.50), 50000000u)) << h.percentile(0.50);
+  EXPECT_TRUE(near(h.percentile(0.99), 99000000u)) << h.percentile(0.99);
+  EXPECT_EQ(100000000u, h.max());
+  EXPECT_EQ(100000000u, h.percentile(1.0));
+  EXPECT_EQ(0u, life::Histogram().percentile(0.5));
+}
+
+// Test case: samples in the top power of two land in the last buckets
+TEST_F(StatsTest, HistogramKeepsTheLargestValues) {
+  life::Histogram h;
+  h.record(Uint64(1) << 63);
+  h.record(~Uint64(0));
+  EXPECT_EQ(2u, h.count());
+  EXPECT_EQ(~Uint64(0), h.max());
+  EXPECT_GE(h.percentile(0.50), Uint64(1) << 63);
+  EXPECT_LE(h.percentile(0.50), (Uint64(1) << 63) + (Uint64(1) << 58));
+  EXPECT_EQ(~Uint64(0), h.percentile(1.0));
+}
+
+// Test case: the tail shows up in p99 even when the median is small
+TEST_F(StatsTest, HistogramShowsTailLatency) {
+  life::Histogram h;
+  for (int i = 0; i < 980; i++) {
+    h.record(100);
+  }
+  for (int i = 0; i < 20; i++) {
+    h.record(5000000);
+  }
+  EXPECT_LE(h.percentile(0.50), 103u);
+  EXPECT_GE(h.percentile(0.99), 5000000u - 5000000u / 32);
+  EXPECT_EQ(5000000u, h.max());
+}
+
+// Test case: timers print after the legacy entries, skipping empty ones
+TEST_F(StatsTest, PrintShowsTimerPercentiles) {
+  const life::StatId render = s.registerTimer(life::RENDER);
+  s.registerTimer(life::PRESENT);
+  s.record(render, 10);
+  s.record(render, 20);
+  s.record(render, 30);
+  s.set(life::FRAMERATE, 60);
+  s.print();
+  EXPECT_EQ(getCapturedOutput(),
+            "Statistics:\nFrame Rate: 60\n"
+            "Render: n=3 p50=20 ns p99=30 ns max=30 ns\n");
+}
+
+// Test case: a scoped timer records its lifetime
+TEST_F(StatsTest, ScopedTimerRecordsOnce) {
+  const life::StatId id = s.registerTimer(life::CALL);
+  {
+    life::ScopedTimer timer(s, id);
+  }
+  EXPECT_EQ(1u, s.histogram(id).count());
+}
+
+// Test case: recording from many threads loses no samples
+TEST_F(StatsTest, ConcurrentRecording) {
+  const life::StatId id = s.registerTimer(life::ITERATE);
+  constexpr int threads = 8;
+  constexpr int samples = 20000;
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([&, t] {
+      // Register concurrently too; every thread must get the same id.
+      EXPECT_EQ(id, s.registerTimer(life::ITERATE));
+      for (int i = 0; i < samples; i++) {
+        s.record(id, static_cast<Uint64>(t * samples + i));
+      }
+      s.set(life::GENERATION, t);
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  const life::Histogram &h = s.histogram(id);
+  EXPECT_EQ(static_cast<Uint64>(threads) * samples, h.count());
+  EXPECT_EQ(static_cast<Uint64>(threads) * samples - 1, h.max());
+}
+
+// Splits text into lines, dropping the trailing newline.
+static std::vector<std::string> lines(const std::string &text) {
+  std::vector<std::string> result;
+  std::stringstream stream(text);
+  std::string line;
+  while (std::getline(stream, line)) {
+    result.push_back(line);
+  }
+  return result;
+}
+
+// Test case: telemetry format follows the file extension
+TEST(TelemetryTest, FormatForPath) {
+  EXPECT_EQ(life::TelemetryFormat::CSV, life::telemetryFormatFor("run.csv"));
+  EXPECT_EQ(life::TelemetryFormat::JSONL,
+            life::telemetryFormatFor("run.jsonl"));
+  EXPECT_EQ(life::TelemetryFormat::JSONL, life::telemetryFormatFor("/dev/stdout"));
+}
+
+// Test case: a JSON lines record carries every value and timer
+TEST(TelemetryTest, JsonRecord) {
+  life::Stats stats;
+  stats.set(life::FRAMERATE, 60);
+  stats.set(life::POPULATION, 1234);
+  const life::StatId iterate = stats.registerTimer(life::ITERATE);
+  stats.record(iterate, 40);
+  std::stringstream out;
+  life::Telemetry telemetry(stats, out, life::TelemetryFormat::JSONL);
+  telemetry.writeRecord();
+  const std::string record = out.str();
+  ASSERT_EQ(1u, lines(record).size());
+  EXPECT_EQ(0u, record.find("{\"time\":"));
+  EXPECT_NE(std::string::npos,
+            record.find("\"values\":{\"Frame Rate\":60,\"Population\":1234}"));
+  EXPECT_NE(std::string::npos,
+            record.find("\"timers\":{\"Iterate\":{\"count\":1,"));
+  EXPECT_NE(std::string::npos,
+            record.find("\"p50\":40,\"p99\":40,\"max\":40,\"mean\":40}}}"));
+}
+
+// Test case: CSV writes its header once and one row per stat per record
+TEST(TelemetryTest, CsvRecords) {
+  life::Stats stats;
+  stats.set(life::GENERATION, 7);
+  stats.record(stats.registerTimer(life::RENDER), 100);
+  std::stringstream out;
+  life::Telemetry telemetry(stats, out, life::TelemetryFormat::CSV);
+  telemetry.writeRecord();
+  telemetry.writeRecord();
+  const std::vector<std::string> rows = lines(out.str());
+  ASSERT_EQ(5u, rows.size());
+  EXPECT_EQ("time,unix_ms,stat,value,count,rate,p50,p99,max,mean", rows[0]);
+  EXPECT_NE(std::string::npos, rows[1].find(",Generation,7,,,,,,"));
+  EXPECT_NE(std::string::npos, rows[2].find(",Render,,1,"));
+  EXPECT_NE(std::string::npos, rows[2].find(",100,100,100,100"));
+  // No new samples between the records, so the second rate is zero.
+  EXPECT_NE(std::string::npos, rows[4].find(",Render,,1,0.000,"));
+}
+
+// Test case: the background thread writes on its interval and once more
+// on stop
+TEST(TelemetryTest, WritesPeriodically) {
+  life::Stats stats;
+  const life::StatId iterate = stats.registerTimer(life::ITERATE);
+  std::stringstream out;
+  life::Telemetry telemetry(stats, out, life::TelemetryFormat::JSONL,
+                            std::chrono::milliseconds(5));
+  telemetry.start();
+  for (int i = 0; i < 30; i++) {
+    stats.record(iterate, 1000);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  telemetry.stop();
+  const std::vector<std::string> records = lines(out.str());
+  EXPECT_GE(records.size(), 3u);
+  EXPECT_NE(std::string::npos, records.back().find("\"count\":30,"));
+}
+
 // You would typically have a main function in a separate file or at the end
 // of your test_*.cpp file to run the tests.
 // Example:
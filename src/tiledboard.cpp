@@ -0,0 +1,284 @@
+// tiledboard.cpp
+#include "./tiledboard.hpp"
+#include "./ThreadPool.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace life {
+namespace {
+constexpr int T = TILED_TILE_SIZE;
+constexpr int TILE_CELLS = T * T;
+
+// tx and ty's bits interleaved, tx's in the even places.
+std::uint64_t mortonCode(const std::uint32_t tx, const std::uint32_t ty) {
+  std::uint64_t code = 0;
+  for (int bit = 0; bit < 32; bit++) {
+    code |= static_cast<std::uint64_t>((tx >> bit) & 1) << (2 * bit);
+    code |= static_cast<std::uint64_t>((ty >> bit) & 1) << (2 * bit + 1);
+  }
+  return code;
+}
+
+void addToNeighbours(TiledBoard &board, const int x, const int y,
+                     const char delta) {
+  const int cx = x % T;
+  const int cy = y % T;
+  if (cx > 0 && cy > 0 && cx < T - 1 && cy < T - 1) {
+    // All eight neighbours share the cell's tile.
+    char *cell = board.cells.data() + cellIndex(board, x, y);
+    cell[-T - 1] += delta;
+    cell[-T] += delta;
+    cell[-T + 1] += delta;
+    cell[-1] += delta;
+    cell[1] += delta;
+    cell[T - 1] += delta;
+    cell[T] += delta;
+    cell[T + 1] += delta;
+    return;
+  }
+  for (int j = -1; j <= 1; j++) {
+    for (int i = -1; i <= 1; i++) {
+      const int nx = x + i;
+      const int ny = y + j;
+      if ((i != 0 || j != 0) && nx >= 0 && ny >= 0 && nx < board.width &&
+          ny < board.height) {
+        board.cells[cellIndex(board, nx, ny)] += delta;
+      }
+    }
+  }
+}
+
+bool allZero(const char *cells, const int count) {
+  std::uint64_t any = 0;
+  int i = 0;
+  for (; i + 8 <= count; i += 8) {
+    std::uint64_t word;
+    std::memcpy(&word, cells + i, sizeof(word));
+    any |= word;
+  }
+  for (; i < count; i++) {
+    any |= static_cast<unsigned char>(cells[i]);
+  }
+  return any == 0;
+}
+
+bool ringSidesDead(const char (&alive)[T + 2][T + 2]) {
+  char any = 0;
+  for (int r = 1; r <= T; r++) {
+    any |= alive[r][0] | alive[r][T + 1];
+  }
+  return any == 0;
+}
+
+// Steps the tile at place into dst. Every cell's next state follows from
+// its own packed value, so the tile and its ring are turned into next
+// alive bits first, then each cell of the tile is recounted from them.
+void stepTile(const TiledBoard &board, const std::uint32_t nextAlive,
+              const int place, char *dst) {
+  const int tile = board.order[place];
+  const int tx = tile % board.tilesX;
+  const int ty = tile / board.tilesX;
+  const int tileWidth = std::min(T, board.width - tx * T);
+  const int tileHeight = std::min(T, board.height - ty * T);
+  const char *src = board.cells.data();
+  const auto tileCells = [&](const int i, const int j) {
+    return src + static_cast<std::size_t>(
+                     board.slot[(ty + j) * board.tilesX + tx + i]) *
+                     TILE_CELLS;
+  };
+  const auto next = [nextAlive](const char cell) {
+    return static_cast<char>((nextAlive >> cell) & 1);
+  };
+
+  // alive[r + 1][c + 1] for tile cell (c, r); anything off the board,
+  // including the padding of an edge tile, stays dead.
+  char alive[T + 2][T + 2];
+  std::memset(alive, 0, sizeof(alive));
+  // The ring first. Only the last tile in a row or column is partial, so
+  // any neighbour tile there is whole.
+  const bool west = tx > 0;
+  const bool east = tx + 1 < board.tilesX;
+  const bool north = ty > 0;
+  const bool south = ty + 1 < board.tilesY;
+  if (north) {
+    const char *cells = tileCells(0, -1) + (T - 1) * T;
+    for (int c = 0; c < tileWidth; c++) {
+      alive[0][c + 1] = next(cells[c]);
+    }
+  }
+  if (south) {
+    const char *cells = tileCells(0, 1);
+    for (int c = 0; c < tileWidth; c++) {
+      alive[T + 1][c + 1] = next(cells[c]);
+    }
+  }
+  if (west) {
+    const char *cells = tileCells(-1, 0) + T - 1;
+    for (int r = 0; r < tileHeight; r++) {
+      alive[r + 1][0] = next(cells[r * T]);
+    }
+  }
+  if (east) {
+    const char *cells = tileCells(1, 0);
+    for (int r = 0; r < tileHeight; r++) {
+      alive[r + 1][T + 1] = next(cells[r * T]);
+    }
+  }
+  if (north && west) {
+    alive[0][0] = next(tileCells(-1, -1)[TILE_CELLS - 1]);
+  }
+  if (north && east) {
+    alive[0][T + 1] = next(tileCells(1, -1)[(T - 1) * T]);
+  }
+  if (south && west) {
+    alive[T + 1][0] = next(tileCells(-1, 1)[T - 1]);
+  }
+  if (south && east) {
+    alive[T + 1][T + 1] = next(tileCells(1, 1)[0]);
+  }
+  // With the ring dead, a tile of zero cells, dead with no live
+  // neighbours, stays that way unless the rule has B0.
+  char *out = dst + static_cast<std::size_t>(place) * TILE_CELLS;
+  const char *own = tileCells(0, 0);
+  if (!(nextAlive & 1) && allZero(own, TILE_CELLS) &&
+      allZero(alive[0], T + 2) && allZero(alive[T + 1], T + 2) &&
+      ringSidesDead(alive)) {
+    std::memset(out, 0, TILE_CELLS);
+    return;
+  }
+  for (int r = 0; r < tileHeight; r++) {
+    for (int c = 0; c < tileWidth; c++) {
+      alive[r + 1][c + 1] = next(own[r * T + c]);
+    }
+  }
+  for (int r = 0; r < tileHeight; r++) {
+    const char *up = alive[r];
+    const char *row = alive[r + 1];
+    const char *down = alive[r + 2];
+    for (int c = 0; c < tileWidth; c++) {
+      const int count = up[c] + up[c + 1] + up[c + 2] + row[c] + row[c + 2] +
+                        down[c] + down[c + 1] + down[c + 2];
+      out[r * T + c] = static_cast<char>((count << 1) | row[c + 1]);
+    }
+  }
+}
+
+template <typename RunBands>
+void stepTiles(TiledBoard &board, const int bands, const RunBands &runBands) {
+  const std::uint32_t nextAlive =
+      packedRuleMask(board.rule.birth, board.rule.survive);
+  board.nextCells.resize(board.cells.size());
+  char *dst = board.nextCells.data();
+  const int places = static_cast<int>(board.order.size());
+  runBands(bands, [&](const int band) {
+    const int begin =
+        static_cast<int>(static_cast<long long>(places) * band / bands);
+    const int end =
+        static_cast<int>(static_cast<long long>(places) * (band + 1) / bands);
+    for (int place = begin; place < end; place++) {
+      stepTile(board, nextAlive, place, dst);
+    }
+  });
+  std::swap(board.cells, board.nextCells);
+}
+} // namespace
+
+TiledBoard genTiledBoard(const int height, const int width) {
+  TiledBoard board;
+  board.height = height;
+  board.width = width;
+  board.tilesX = (width + T - 1) / T;
+  board.tilesY = (height + T - 1) / T;
+  const int tiles = board.tilesX * board.tilesY;
+  board.order.resize(tiles);
+  for (int tile = 0; tile < tiles; tile++) {
+    board.order[tile] = tile;
+  }
+  std::vector<std::uint64_t> codes(tiles);
+  for (int tile = 0; tile < tiles; tile++) {
+    codes[tile] = mortonCode(tile % board.tilesX, tile / board.tilesX);
+  }
+  std::sort(board.order.begin(), board.order.end(),
+            [&codes](const int a, const int b) { return codes[a] < codes[b]; });
+  board.slot.resize(tiles);
+  for (int place = 0; place < tiles; place++) {
+    board.slot[board.order[place]] = place;
+  }
+  // Padding cells are never written, so both buffers keep them dead.
+  board.cells.assign(static_cast<std::size_t>(tiles) * TILE_CELLS, 0);
+  board.nextCells.assign(board.cells.size(), 0);
+  return board;
+}
+
+char getCellState(const TiledBoard &board, const int x, const int y) {
+  return board.cells[cellIndex(board, x, y)] & ALIVE;
+}
+
+int neighborCount(const TiledBoard &board, const int x, const int y) {
+  return board.cells[cellIndex(board, x, y)] >> 1;
+}
+
+void setCellState(TiledBoard &board, const int x, const int y,
+                  const char state) {
+  char &cell = board.cells[cellIndex(board, x, y)];
+  if ((cell & ALIVE) == state) {
+    return;
+  }
+  cell ^= ALIVE;
+  addToNeighbours(board, x, y, state == ALIVE ? 2 : -2);
+}
+
+void iterateBoard(TiledBoard &board) {
+  stepTiles(board, 1, [](const int count, const auto &task) {
+    for (int i = 0; i < count; i++) {
+      task(i);
+    }
+  });
+}
+
+void iterateBoard(TiledBoard &board, ThreadPool &pool) {
+  // Runs of tiles rather than single ones, so neighbouring tiles in
+  // Morton order share a thread's cache.
+  const int bands = std::max(
+      1, std::min(static_cast<int>(board.order.size()), pool.size() * 4));
+  stepTiles(board, bands,
+            [&pool](const int count, const std::function<void(int)> &task) {
+              pool.run(count, task);
+            });
+}
+
+std::uint64_t population(const TiledBoard &board) {
+  std::uint64_t count = 0;
+  for (const char cell : board.cells) {
+    count += static_cast<std::uint64_t>(cell & ALIVE);
+  }
+  return count;
+}
+
+TiledBoard toTiledBoard(const GameBoard &gameBoard) {
+  TiledBoard board = genTiledBoard(gameBoard.height, gameBoard.width);
+  board.rule = gameBoard.rule;
+  for (int y = 0; y < gameBoard.height; y++) {
+    for (int x = 0; x < gameBoard.width; x++) {
+      if (getCellState(gameBoard, x, y) == ALIVE) {
+        setCellState(board, x, y, ALIVE);
+      }
+    }
+  }
+  return board;
+}
+
+GameBoard toGameBoard(const TiledBoard &board) {
+  GameBoard gameBoard = genBoard(board.height, board.width);
+  setRule(gameBoard, board.rule);
+  for (int y = 0; y < board.height; y++) {
+    for (int x = 0; x < board.width; x++) {
+      if (getCellState(board, x, y) == ALIVE) {
+        setCellState(gameBoard, x, y, ALIVE);
+      }
+    }
+  }
+  return gameBoard;
+}
+} // namespace life
@@ -0,0 +1,67 @@
+// tiledboard.hpp
+#ifndef TILEDBOARD_H
+#define TILEDBOARD_H
+
+#include "life.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace life {
+
+class ThreadPool;
+
+// Side of a TiledBoard tile.
+constexpr int TILED_TILE_SIZE = 64;
+
+// GameBoard's packed cells, (neighbour count << 1) | alive, kept in square
+// tiles of TILED_TILE_SIZE rows that each lie contiguous in memory, with
+// the tiles in Morton (Z) order so tiles near each other on the board are
+// near each other in memory too. A cell and its neighbours then sit on
+// three adjacent cache lines however wide the board is, where row-major
+// rows lie a board's width apart. The functions below hide the layout.
+// Edge tiles are padded; cells outside the board are dead, as on a
+// GameBoard with a dead boundary.
+struct TiledBoard {
+    Board cells;
+    int height;
+    int width;
+    int tilesX;
+    int tilesY;
+    // Tile ty * tilesX + tx's place in Morton order, and the tile at each
+    // place. Tile grids need not be square or a power of two across, so
+    // the order is kept as a table rather than computed.
+    std::vector<int> slot;
+    std::vector<int> order;
+    Rule rule = CONWAY;
+    // Back buffer for iterateBoard, swapped with cells every generation.
+    Board nextCells;
+};
+
+TiledBoard genTiledBoard(int height = LIFE_BOARD_HEIGHT,
+                         int width = LIFE_BOARD_WIDTH);
+// Where cell (x, y) lives in cells.
+inline std::size_t cellIndex(const TiledBoard &board, const int x,
+                             const int y) {
+    const int tile = (y / TILED_TILE_SIZE) * board.tilesX + x / TILED_TILE_SIZE;
+    return static_cast<std::size_t>(board.slot[tile]) * TILED_TILE_SIZE *
+               TILED_TILE_SIZE +
+           (y % TILED_TILE_SIZE) * TILED_TILE_SIZE + x % TILED_TILE_SIZE;
+}
+int neighborCount(const TiledBoard &board, int x, int y);
+char getCellState(const TiledBoard &board, int x, int y);
+void setCellState(TiledBoard &board, int x, int y, char state);
+// Steps the board a tile at a time in Morton order. Each tile's next alive
+// bits and those of the ring of cells around it are gathered into a block
+// small enough to stay in L1 while the tile's counts are rebuilt from it.
+void iterateBoard(TiledBoard &board);
+// Steps runs of tiles on the pool; the result matches iterateBoard(board).
+void iterateBoard(TiledBoard &board, ThreadPool &pool);
+std::uint64_t population(const TiledBoard &board);
+
+// Conversions to and from the row-major board, used to cross-check
+// engines. The rule goes with the cells.
+TiledBoard toTiledBoard(const GameBoard &gameBoard);
+GameBoard toGameBoard(const TiledBoard &board);
+} // namespace life
+
+#endif // TILEDBOARD_H